@@ -39,6 +39,26 @@
 	return [self.cryptor encryptDirectoryId:directoryId];
 }
 
+- (NSUInteger)directoryIdCacheCapacity {
+	return self.cryptor.directoryIdCacheCapacity;
+}
+
+- (void)setDirectoryIdCacheCapacity:(NSUInteger)directoryIdCacheCapacity {
+	self.cryptor.directoryIdCacheCapacity = directoryIdCacheCapacity;
+}
+
+- (NSUInteger)directoryIdCacheHitCount {
+	return self.cryptor.directoryIdCacheHitCount;
+}
+
+- (NSUInteger)directoryIdCacheMissCount {
+	return self.cryptor.directoryIdCacheMissCount;
+}
+
+- (void)invalidateDirectoryIdCache {
+	[self.cryptor invalidateDirectoryIdCache];
+}
+
 - (NSString *)encryptFilename:(NSString *)filename insideDirectoryWithId:(NSString *)directoryId {
 	return [self.cryptor encryptFilename:filename insideDirectoryWithId:directoryId];
 }
@@ -47,8 +67,50 @@
 	return [self.cryptor decryptFilename:filename insideDirectoryWithId:directoryId];
 }
 
+- (NSDictionary *)decryptFilenames:(NSArray *)filenames insideDirectoryWithId:(NSString *)directoryId {
+	return [self.cryptor decryptFilenames:filenames insideDirectoryWithId:directoryId];
+}
+
+- (NSInteger)encryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength {
+	return [self.cryptor encryptFilenameUTF8String:filename length:filenameLength insideDirectoryWithIdUTF8String:directoryId length:directoryIdLength buffer:buffer maxLength:maxLength];
+}
+
+- (NSInteger)decryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength {
+	return [self.cryptor decryptFilenameUTF8String:filename length:filenameLength insideDirectoryWithIdUTF8String:directoryId length:directoryIdLength buffer:buffer maxLength:maxLength];
+}
+
+- (NSUInteger)encryptedFilenameLengthForFilenameLength:(NSUInteger)filenameLength {
+	return [self.cryptor encryptedFilenameLengthForFilenameLength:filenameLength];
+}
+
+- (NSUInteger)maxFilenameLengthForEncryptedFilenameLength:(NSUInteger)encryptedFilenameLength {
+	return [self.cryptor maxFilenameLengthForEncryptedFilenameLength:encryptedFilenameLength];
+}
+
+#pragma mark - Path Resolution
+
+- (NSString *)ciphertextDirectoryPathForCleartextPath:(NSString *)cleartextPath directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error {
+	return [self.cryptor ciphertextDirectoryPathForCleartextPath:cleartextPath directoryIdProvider:directoryIdProvider error:error];
+}
+
+- (NSString *)ciphertextPathForCleartextPath:(NSString *)cleartextPath directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error {
+	return [self.cryptor ciphertextPathForCleartextPath:cleartextPath directoryIdProvider:directoryIdProvider error:error];
+}
+
+- (void)invalidateResolvedPathsWithPrefix:(NSString *)cleartextPath {
+	[self.cryptor invalidateResolvedPathsWithPrefix:cleartextPath];
+}
+
 #pragma mark - File Content Encryption and Decryption
 
+- (NSUInteger)maxConcurrentChunkOperationCount {
+	return self.cryptor.maxConcurrentChunkOperationCount;
+}
+
+- (void)setMaxConcurrentChunkOperationCount:(NSUInteger)maxConcurrentChunkOperationCount {
+	self.cryptor.maxConcurrentChunkOperationCount = maxConcurrentChunkOperationCount;
+}
+
 - (void)authenticateFileAtPath:(NSString *)path callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback {
 	NSParameterAssert(callback);
 	dispatch_async(self.queue, ^{
@@ -100,6 +162,38 @@
 	});
 }
 
+#pragma mark - Random Access File Content Encryption and Decryption
+
+- (NSData *)decryptRange:(NSRange)range ofFileAtPath:(NSString *)path error:(NSError **)error {
+	return [self.cryptor decryptRange:range ofFileAtPath:path error:error];
+}
+
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)path atOffset:(NSUInteger)offset error:(NSError **)error {
+	return [self.cryptor writeData:data toFileAtPath:path atOffset:offset error:error];
+}
+
+- (BOOL)appendData:(NSData *)data toFileAtPath:(NSString *)path error:(NSError **)error {
+	return [self.cryptor appendData:data toFileAtPath:path error:error];
+}
+
+- (BOOL)truncateFileAtPath:(NSString *)path toCleartextSize:(NSUInteger)size error:(NSError **)error {
+	return [self.cryptor truncateFileAtPath:path toCleartextSize:size error:error];
+}
+
+#pragma mark - Streaming File Content Encryption and Decryption
+
+- (SETOFileContentEncryptor *)fileContentEncryptorWithError:(NSError **)error {
+	return [self.cryptor fileContentEncryptorWithError:error];
+}
+
+- (SETOFileContentDecryptor *)fileContentDecryptorWithSource:(SETOCryptorReadCallback)source error:(NSError **)error {
+	return [self.cryptor fileContentDecryptorWithSource:source error:error];
+}
+
+- (SETOFileContentDecryptor *)fileContentDecryptorWithInputStream:(NSInputStream *)inputStream error:(NSError **)error {
+	return [self.cryptor fileContentDecryptorWithInputStream:inputStream error:error];
+}
+
 #pragma mark - Chunk Sizes
 
 - (NSUInteger)ciphertextSizeFromCleartextSize:(NSUInteger)cleartextSize {
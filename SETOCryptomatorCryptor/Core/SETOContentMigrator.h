@@ -0,0 +1,39 @@
+//
+//  SETOContentMigrator.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "SETOCryptor.h"
+
+/**
+ *  @c SETOContentMigrator re-encrypts file content from one vault version to another, e.g. from version 3 to version 7. Each file is decrypted chunk by chunk and the cleartext is passed straight to the encryptor in memory, so no cleartext is ever written to disk.
+ */
+@interface SETOContentMigrator : NSObject
+
+/**
+ *  Initializes the migrator.
+ *
+ *  @param sourceCryptor Cryptor of the vault version to migrate from.
+ *  @param targetCryptor Cryptor of the vault version to migrate to. It must support streaming file content encryption, i.e. vault version 5 and higher.
+ *
+ *  @return The newly-initialized migrator.
+ */
+- (instancetype)initWithSourceCryptor:(SETOCryptor *)sourceCryptor targetCryptor:(SETOCryptor *)targetCryptor NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ *  Re-encrypts files concurrently. For vault version 3 and 4, the random padding is dropped, since the file header carries the actual file size. If a file fails to migrate, its partial target file is removed and no further files are started.
+ *
+ *  @param sourcePaths      Paths of the files to migrate.
+ *  @param targetPaths      Paths of the re-encrypted files, in the same order as @p sourcePaths. They must differ from the source paths.
+ *  @param callback         Completion callback with an error object if a file could not be migrated.
+ *  @param progressCallback Progress callback with the fraction of migrated files, which may be called from any thread.
+ */
+- (void)migrateFilesAtPaths:(NSArray *)sourcePaths toPaths:(NSArray *)targetPaths callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback;
+
+@end
@@ -0,0 +1,152 @@
+//
+//  SETOContentMigrator.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOContentMigrator.h"
+#import "SETOFileContentDecryptor.h"
+#import "SETOFileContentEncryptor.h"
+
+#import "SETOFileHandle.h"
+
+@interface SETOContentMigrator ()
+@property (nonatomic, strong) SETOCryptor *sourceCryptor;
+@property (nonatomic, strong) SETOCryptor *targetCryptor;
+@end
+
+@implementation SETOContentMigrator
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSourceCryptor:(SETOCryptor *)sourceCryptor targetCryptor:(SETOCryptor *)targetCryptor {
+	NSParameterAssert(sourceCryptor);
+	NSParameterAssert(targetCryptor);
+	if (self = [super init]) {
+		self.sourceCryptor = sourceCryptor;
+		self.targetCryptor = targetCryptor;
+	}
+	return self;
+}
+
+#pragma mark - Migration
+
+- (void)migrateFilesAtPaths:(NSArray *)sourcePaths toPaths:(NSArray *)targetPaths callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback {
+	NSParameterAssert(sourcePaths);
+	NSParameterAssert(targetPaths);
+	NSParameterAssert(sourcePaths.count == targetPaths.count);
+	NSParameterAssert(callback);
+
+	// init progress:
+	if (progressCallback) {
+		progressCallback(0.0);
+	}
+
+	// migrate files concurrently, each file is processed by one worker with its own decryptor and encryptor:
+	NSUInteger fileCount = sourcePaths.count;
+	__block NSUInteger migratedFileCount = 0;
+	__block NSError *migrationError;
+	NSObject *lock = [[NSObject alloc] init];
+	dispatch_apply(fileCount, dispatch_get_global_queue(qos_class_self(), 0), ^(size_t i) {
+		@synchronized(lock) {
+			if (migrationError) {
+				return;
+			}
+		}
+		NSError *fileError;
+		BOOL success = [self migrateFileAtPath:sourcePaths[i] toPath:targetPaths[i] error:&fileError];
+		@synchronized(lock) {
+			if (!success) {
+				migrationError = migrationError ?: fileError;
+				return;
+			}
+			migratedFileCount++;
+			if (progressCallback) {
+				progressCallback((CGFloat)migratedFileCount / fileCount);
+			}
+		}
+	});
+	if (migrationError) {
+		callback(migrationError);
+		return;
+	}
+
+	// done:
+	if (progressCallback) {
+		progressCallback(1.0);
+	}
+	callback(nil);
+}
+
+- (BOOL)migrateFileAtPath:(NSString *)sourcePath toPath:(NSString *)targetPath error:(NSError **)error {
+	// open ciphertext input:
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:sourcePath error:error];
+	if (!input) {
+		return NO;
+	}
+	__block uint64_t inputOffset = 0;
+	SETOFileContentDecryptor *decryptor = [self.sourceCryptor fileContentDecryptorWithSource:^NSInteger(uint8_t *buffer, NSUInteger maxLength) {
+		NSInteger bytesRead = [input readBytes:buffer length:maxLength atOffset:inputOffset];
+		if (bytesRead > 0) {
+			inputOffset += bytesRead;
+		}
+		return bytesRead;
+	} error:error];
+	SETOFileContentEncryptor *encryptor = decryptor ? [self.targetCryptor fileContentEncryptorWithError:error] : nil;
+	if (!encryptor) {
+		[input closeFile];
+		return NO;
+	}
+
+	// open ciphertext output:
+	SETOFileHandle *output = [SETOFileHandle fileHandleForWritingAtPath:targetPath error:error];
+	if (!output) {
+		[input closeFile];
+		return NO;
+	}
+
+	// pipe cleartext chunks from decryptor to encryptor, an empty chunk marks the end:
+	NSError *migrationError;
+	uint64_t outputOffset = 0;
+	BOOL atEnd = NO;
+	BOOL failed = NO;
+	while (!atEnd && !failed) {
+		@autoreleasepool {
+			NSData *cleartext = [decryptor readChunkWithError:&migrationError];
+			if (!cleartext) {
+				migrationError = migrationError ?: [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil];
+				failed = YES;
+				break;
+			}
+			atEnd = cleartext.length == 0;
+			NSData *ciphertext = atEnd ? [encryptor finishWithError:&migrationError] : [encryptor updateWithData:cleartext error:&migrationError];
+			if (!ciphertext) {
+				migrationError = migrationError ?: [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+				failed = YES;
+				break;
+			}
+			if (ciphertext.length > 0 && ![output writeBytes:ciphertext.bytes length:ciphertext.length atOffset:outputOffset]) {
+				migrationError = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+				failed = YES;
+				break;
+			}
+			outputOffset += ciphertext.length;
+		}
+	}
+
+	// done, partial output is removed:
+	[input closeFile];
+	[output closeFile];
+	if (failed) {
+		[[NSFileManager defaultManager] removeItemAtPath:targetPath error:NULL];
+		if (error) {
+			*error = migrationError;
+		}
+		return NO;
+	}
+	return YES;
+}
+
+@end
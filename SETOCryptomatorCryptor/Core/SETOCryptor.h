@@ -10,6 +10,8 @@
 #import <UIKit/UIKit.h>
 
 @class SETOMasterKey;
+@class SETOFileContentEncryptor;
+@class SETOFileContentDecryptor;
 
 extern NSString *const kSETOCryptorErrorDomain;
 
@@ -17,11 +19,14 @@ typedef NS_ENUM(NSInteger, SETOCryptorError) {
 	SETOCryptorCorruptedFileHeaderError,
 	SETOCryptorAuthenticationFailedError,
 	SETOCryptorEncryptionFailedError,
-	SETOCryptorDecryptionFailedError
+	SETOCryptorDecryptionFailedError,
+	SETOCryptorDirectoryIdLookupFailedError
 };
 
 typedef void (^SETOCryptorCompletionCallback)(NSError *error);
 typedef void (^SETOCryptorProgressCallback)(CGFloat progress);
+typedef NSInteger (^SETOCryptorReadCallback)(uint8_t *buffer, NSUInteger maxLength);
+typedef NSString *(^SETOCryptorDirectoryIdProvider)(NSString *ciphertextPath, NSError **error);
 
 /**
  *  @c SETOCryptor is the core class for cryptographic operations on Cryptomator vaults.
@@ -63,6 +68,26 @@ typedef void (^SETOCryptorProgressCallback)(CGFloat progress);
  */
 - (NSString *)encryptDirectoryId:(NSString *)directoryId;
 
+/**
+ *  The maximum number of encrypted directory IDs that are cached by encryptDirectoryId:. Defaults to @p 1000. Once the capacity is reached, the least recently used entry is evicted. Set to @p 0 to disable caching.
+ */
+@property (nonatomic, assign) NSUInteger directoryIdCacheCapacity;
+
+/**
+ *  Number of encryptDirectoryId: calls that were answered from the cache.
+ */
+@property (nonatomic, readonly) NSUInteger directoryIdCacheHitCount;
+
+/**
+ *  Number of encryptDirectoryId: calls that had to encrypt the directory ID.
+ */
+@property (nonatomic, readonly) NSUInteger directoryIdCacheMissCount;
+
+/**
+ *  Removes all cached encrypted directory IDs. Hit and miss counts are kept.
+ */
+- (void)invalidateDirectoryIdCache;
+
 /**
  *  Encrypts filename.
  *
@@ -83,11 +108,123 @@ typedef void (^SETOCryptorProgressCallback)(CGFloat progress);
  */
 - (NSString *)decryptFilename:(NSString *)filename insideDirectoryWithId:(NSString *)directoryId;
 
+/**
+ *  Decrypts all filenames inside a directory at once, e.g. of a directory listing. The directory ID is processed only once and the filenames are decrypted concurrently, which is considerably faster than calling decryptFilename:insideDirectoryWithId: for each filename of a large directory.
+ *
+ *  @param filenames   Ciphertexts only. Any additional strings like file extensions need to be stripped first.
+ *  @param directoryId The same directed ID used during encryption as associated data.
+ *
+ *  @return Dictionary mapping each ciphertext filename to its decrypted filename. Filenames that could not be decrypted are omitted. Returns @p nil if the filenames could not be processed at all, a partial result is never returned.
+ */
+- (NSDictionary *)decryptFilenames:(NSArray *)filenames insideDirectoryWithId:(NSString *)directoryId;
+
+/**
+ *  Encrypts filename into a caller-provided buffer without any heap allocation, e.g. for tight enumeration loops. The result is the same as with encryptFilename:insideDirectoryWithId:.
+ *
+ *  @param filename          UTF-8 bytes of the original filename including cleartext file extension. It does not need to be null-terminated.
+ *  @param filenameLength    Number of bytes of @p filename.
+ *  @param directoryId       UTF-8 bytes of the directory ID that will be used as associated data. It does not need to be null-terminated.
+ *  @param directoryIdLength Number of bytes of @p directoryId.
+ *  @param buffer            Buffer for the encrypted filename. It must not overlap with @p filename or @p directoryId. The result is not null-terminated.
+ *  @param maxLength         Size of @p buffer. 2 * (@p filenameLength + 16) bytes are always sufficient.
+ *
+ *  @return Number of bytes written to @p buffer or -1 if the buffer is too small or encryption failed.
+ */
+- (NSInteger)encryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength;
+
+/**
+ *  Decrypts filename into a caller-provided buffer without any heap allocation, e.g. for tight enumeration loops. The result is the same as with decryptFilename:insideDirectoryWithId:.
+ *
+ *  @param filename          Ciphertext only. Any additional strings like file extensions need to be stripped first. It does not need to be null-terminated.
+ *  @param filenameLength    Number of bytes of @p filename.
+ *  @param directoryId       UTF-8 bytes of the same directory ID used during encryption as associated data. It does not need to be null-terminated.
+ *  @param directoryIdLength Number of bytes of @p directoryId.
+ *  @param buffer            Buffer for the UTF-8 bytes of the decrypted filename. The result is not null-terminated. If decryption fails, the buffer contents are undefined.
+ *  @param maxLength         Size of @p buffer. @p filenameLength bytes are always sufficient.
+ *
+ *  @return Number of bytes written to @p buffer or -1 if the buffer is too small or decryption failed.
+ */
+- (NSInteger)decryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength;
+
+/**
+ *  Calculates the length of an encrypted filename without encrypting it, e.g. to decide whether a name needs to be shortened. The length does not depend on the directory ID.
+ *
+ *  @param filename Original filename including cleartext file extension.
+ *
+ *  @return Length of the encrypted filename returned by encryptFilename:insideDirectoryWithId:, without any file extension.
+ */
+- (NSUInteger)encryptedFilenameLengthForFilename:(NSString *)filename;
+
+/**
+ *  Calculates the length of an encrypted filename from the length of the original filename without encrypting it.
+ *
+ *  @param filenameLength Number of UTF-8 bytes of the original filename.
+ *
+ *  @return Length of the encrypted filename, without any file extension.
+ */
+- (NSUInteger)encryptedFilenameLengthForFilenameLength:(NSUInteger)filenameLength;
+
+/**
+ *  Calculates the maximum length of an original filename whose encrypted filename does not exceed the given length, e.g. to validate names before encrypting them.
+ *
+ *  @param encryptedFilenameLength Maximum length of the encrypted filename, without any file extension.
+ *
+ *  @return Maximum number of UTF-8 bytes of the original filename or @p 0 if no filename fits.
+ */
+- (NSUInteger)maxFilenameLengthForEncryptedFilenameLength:(NSUInteger)encryptedFilenameLength;
+
+/**----------------------
+ *  @name Path Resolution
+ *-----------------------
+ */
+
+/**
+ *  Resolves the ciphertext path of the directory that stores the contents of a cleartext directory, e.g. @c d/AB/CDEFGHIJKLMNOPQRSTUVWXYZ234567.
+ *
+ *  Walks the path from the root directory: each name is encrypted with encryptFilename:insideDirectoryWithId: and the directory ID of each directory is fetched with @p directoryIdProvider. Resolved directory IDs are memoized per cleartext path, so the provider is only called for directories that have not been resolved before.
+ *
+ *  @param cleartextPath       Absolute cleartext path of a directory, e.g. @c /foo/bar. The root directory is @c /.
+ *  @param directoryIdProvider Called synchronously with the ciphertext path of a directory node relative to the vault root: the file with the encrypted name prefixed by @c 0 for vault version 5 and lower, the @c .c9r directory containing the @c dir.c9r file for vault version 7 and higher. Returns the directory ID stored in that node or @p nil after setting its error argument.
+ *  @param error               On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return Ciphertext directory path relative to the vault root or @p nil if an error occurred.
+ */
+- (NSString *)ciphertextDirectoryPathForCleartextPath:(NSString *)cleartextPath directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error;
+
+/**
+ *  Resolves the ciphertext path of a cleartext file or directory node, i.e. the encrypted name inside the ciphertext directory path of its parent.
+ *
+ *  For vault version 7 and higher, the node path carries the @c .c9r extension and directory nodes are directories containing a @c dir.c9r file. For older vault versions, the node path is the path of a file node, the node of a directory is a file with the encrypted name prefixed by @c 0 instead. Shortening of long names is not applied. The root directory @c / has no node, so its ciphertext directory path is returned instead.
+ *
+ *  @param cleartextPath       Absolute cleartext path of a file or directory, e.g. @c /foo/bar.txt. The root directory is @c /.
+ *  @param directoryIdProvider Called synchronously to fetch the directory IDs of the parent directories, see ciphertextDirectoryPathForCleartextPath:directoryIdProvider:error:.
+ *  @param error               On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return Ciphertext node path relative to the vault root or @p nil if an error occurred.
+ */
+- (NSString *)ciphertextPathForCleartextPath:(NSString *)cleartextPath directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error;
+
+/**
+ *  Forgets memoized directory IDs of a cleartext directory and all of its descendants. Call this after a directory has been moved or deleted.
+ *
+ *  @param cleartextPath Absolute cleartext path of a directory. Pass @c / to forget all directory IDs.
+ */
+- (void)invalidateResolvedPathsWithPrefix:(NSString *)cleartextPath;
+
 /**---------------------------------------------
  *  @name File Content Encryption and Decryption
  *----------------------------------------------
  */
 
+/**
+ *  The maximum number of file content chunks that are processed concurrently. Defaults to @p 1, i.e. chunks are processed sequentially on the calling thread.
+ *
+ *  If greater than @p 1, file content encryption and decryption distribute chunks among that many workers. Each worker reads and writes its chunks at their positions in the files, so no reordering is needed. Use @p NSProcessInfo.processInfo.activeProcessorCount to utilize all cores. Callbacks are still invoked on the calling thread.
+ *
+ *  @note Only taken into account by cryptors for vault version 5 and higher.
+ */
+@property (nonatomic, assign) NSUInteger maxConcurrentChunkOperationCount;
+
 /**
  *  Authenticate file content.
  *
@@ -117,6 +254,104 @@ typedef void (^SETOCryptorProgressCallback)(CGFloat progress);
  */
 - (void)decryptFileAtPath:(NSString *)inPath toPath:(NSString *)outPath callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback;
 
+/**-----------------------------------------------------------
+ *  @name Random Access File Content Encryption and Decryption
+ *------------------------------------------------------------
+ */
+
+/**
+ *  Decrypts a range of file content. Only the file header and the chunks covering the requested range are read, authenticated and decrypted.
+ *
+ *  @param range The cleartext byte range. Bytes beyond the end of the cleartext are omitted.
+ *  @param path  The path of a ciphertext file.
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return The cleartext bytes within the range, or @p nil if an error occurred.
+ *
+ *  @note Only supported by cryptors for vault version 5 and higher.
+ */
+- (NSData *)decryptRange:(NSRange)range ofFileAtPath:(NSString *)path error:(NSError **)error;
+
+/**
+ *  Writes data into existing file content. Only the chunks affected by the write are decrypted, patched and re-encrypted in place. The file header and its file key remain unchanged.
+ *
+ *  @param data   The cleartext data to write.
+ *  @param path   The path of a ciphertext file.
+ *  @param offset The cleartext offset at which to write the data. Must not be greater than the cleartext size, the file is extended if the data exceeds its end.
+ *  @param error  On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return @p YES if the data has been written successfully, otherwise @p NO.
+ *
+ *  @note Only supported by cryptors for vault version 5 and higher.
+ */
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)path atOffset:(NSUInteger)offset error:(NSError **)error;
+
+/**
+ *  Appends data to existing file content. Only the trailing partial chunk is re-encrypted, followed by new chunks.
+ *
+ *  @param data  The cleartext data to append.
+ *  @param path  The path of a ciphertext file.
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return @p YES if the data has been appended successfully, otherwise @p NO.
+ *
+ *  @note Only supported by cryptors for vault version 5 and higher.
+ */
+- (BOOL)appendData:(NSData *)data toFileAtPath:(NSString *)path error:(NSError **)error;
+
+/**
+ *  Truncates or extends file content to the specified cleartext size. When truncating, only the new trailing partial chunk is re-encrypted before the file is trimmed to the corresponding ciphertext size. When extending, zeros are appended.
+ *
+ *  @param path  The path of a ciphertext file.
+ *  @param size  The new cleartext size.
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return @p YES if the file has been truncated successfully, otherwise @p NO.
+ *
+ *  @note Only supported by cryptors for vault version 5 and higher.
+ */
+- (BOOL)truncateFileAtPath:(NSString *)path toCleartextSize:(NSUInteger)size error:(NSError **)error;
+
+/**-------------------------------------------------------
+ *  @name Streaming File Content Encryption and Decryption
+ *--------------------------------------------------------
+ */
+
+/**
+ *  Creates an encryptor for file content that is not available as a file, e.g. when streaming ciphertext into an upload. A new file header with a random file key is created for every encryptor.
+ *
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return A new file content encryptor, or @p nil if an error occurred.
+ *
+ *  @note Only supported by cryptors for vault version 5 and higher.
+ */
+- (SETOFileContentEncryptor *)fileContentEncryptorWithError:(NSError **)error;
+
+/**
+ *  Creates a decryptor for file content that is not available as a file, e.g. when decrypting a download while it arrives.
+ *
+ *  @param source A block object to be executed whenever the decryptor needs more ciphertext. This block takes two arguments: The buffer to fill and its capacity. It returns the number of bytes written to the buffer, @p 0 at the end of the ciphertext, or a negative value if an error occurred. It may return less bytes than requested at any time.
+ *  @param error  On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return A new file content decryptor, or @p nil if an error occurred.
+ *
+ *  @note For vault version 3 and 4, decryption ends at the file size stored in the file header, the random padding behind it is not read.
+ */
+- (SETOFileContentDecryptor *)fileContentDecryptorWithSource:(SETOCryptorReadCallback)source error:(NSError **)error;
+
+/**
+ *  Creates a decryptor for file content read from an input stream, e.g. of a network connection or of in-memory data.
+ *
+ *  @param inputStream The input stream providing the ciphertext. It is opened if necessary and read synchronously whenever the decryptor needs more ciphertext.
+ *  @param error       On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return A new file content decryptor, or @p nil if an error occurred.
+ *
+ *  @note For vault version 3 and 4, decryption ends at the file size stored in the file header, the random padding behind it is not read.
+ */
+- (SETOFileContentDecryptor *)fileContentDecryptorWithInputStream:(NSInputStream *)inputStream error:(NSError **)error;
+
 /**----------------------------
  *  @name File Size Calculation
  *-----------------------------
@@ -8,11 +8,18 @@
 
 #import "SETOCryptor.h"
 #import "SETOMasterKey.h"
+#import "SETOLRUCache.h"
+#import "SETOMasterKeyContext.h"
 
 NSString *const kSETOCryptorErrorDomain = @"SETOCryptorErrorDomain";
+NSUInteger const kSETOCryptorDefaultDirectoryIdCacheCapacity = 1000;
+NSUInteger const kSETOCryptorResolvedDirectoryIdCacheCapacity = 1000;
 
 @interface SETOCryptor ()
 @property (nonatomic, strong) SETOMasterKey *masterKey;
+@property (nonatomic, strong) SETOMasterKeyContext *masterKeyContext;
+@property (nonatomic, strong) SETOLRUCache *directoryIdCache;
+@property (nonatomic, strong) SETOLRUCache *resolvedDirectoryIds;
 @end
 
 @implementation SETOCryptor
@@ -22,6 +29,13 @@ NSString *const kSETOCryptorErrorDomain = @"SETOCryptorErrorDomain";
 - (instancetype)initWithMasterKey:(SETOMasterKey *)masterKey {
 	if (self = [super init]) {
 		self.masterKey = masterKey;
+		// decorators like SETOAsyncCryptor have no master key of their own:
+		if (masterKey) {
+			self.masterKeyContext = [[SETOMasterKeyContext alloc] initWithMasterKey:masterKey];
+		}
+		self.directoryIdCache = [[SETOLRUCache alloc] initWithCapacity:kSETOCryptorDefaultDirectoryIdCacheCapacity];
+		self.resolvedDirectoryIds = [[SETOLRUCache alloc] initWithCapacity:kSETOCryptorResolvedDirectoryIdCacheCapacity];
+		_maxConcurrentChunkOperationCount = 1;
 	}
 	return self;
 }
@@ -33,6 +47,26 @@ NSString *const kSETOCryptorErrorDomain = @"SETOCryptorErrorDomain";
 	return nil;
 }
 
+- (NSUInteger)directoryIdCacheCapacity {
+	return self.directoryIdCache.capacity;
+}
+
+- (void)setDirectoryIdCacheCapacity:(NSUInteger)directoryIdCacheCapacity {
+	self.directoryIdCache.capacity = directoryIdCacheCapacity;
+}
+
+- (NSUInteger)directoryIdCacheHitCount {
+	return self.directoryIdCache.hitCount;
+}
+
+- (NSUInteger)directoryIdCacheMissCount {
+	return self.directoryIdCache.missCount;
+}
+
+- (void)invalidateDirectoryIdCache {
+	[self.directoryIdCache removeAllObjects];
+}
+
 - (NSString *)encryptFilename:(NSString *)filename insideDirectoryWithId:(NSString *)directoryId {
 	NSAssert(NO, @"Overwrite this method.");
 	return nil;
@@ -43,6 +77,164 @@ NSString *const kSETOCryptorErrorDomain = @"SETOCryptorErrorDomain";
 	return nil;
 }
 
+- (NSDictionary *)decryptFilenames:(NSArray *)filenames insideDirectoryWithId:(NSString *)directoryId {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+- (NSInteger)encryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength {
+	NSAssert(NO, @"Overwrite this method.");
+	return -1;
+}
+
+- (NSInteger)decryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength {
+	NSAssert(NO, @"Overwrite this method.");
+	return -1;
+}
+
+- (NSUInteger)encryptedFilenameLengthForFilename:(NSString *)filename {
+	NSParameterAssert(filename);
+	return [self encryptedFilenameLengthForFilenameLength:[filename lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (NSUInteger)encryptedFilenameLengthForFilenameLength:(NSUInteger)filenameLength {
+	NSAssert(NO, @"Overwrite this method.");
+	return NSUIntegerMax;
+}
+
+- (NSUInteger)maxFilenameLengthForEncryptedFilenameLength:(NSUInteger)encryptedFilenameLength {
+	NSAssert(NO, @"Overwrite this method.");
+	return 0;
+}
+
+#pragma mark - Path Resolution
+
+- (NSString *)ciphertextDirectoryPathForCleartextPath:(NSString *)cleartextPath directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error {
+	NSParameterAssert(cleartextPath);
+	NSParameterAssert(directoryIdProvider);
+	NSArray *components = [self componentsOfCleartextPath:cleartextPath];
+	NSString *directoryId = [self directoryIdForCleartextPathComponents:components directoryIdProvider:directoryIdProvider error:error];
+	if (!directoryId) {
+		return nil;
+	}
+	return [self ciphertextDirectoryPathForDirectoryId:directoryId error:error];
+}
+
+- (NSString *)ciphertextPathForCleartextPath:(NSString *)cleartextPath directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error {
+	NSParameterAssert(cleartextPath);
+	NSParameterAssert(directoryIdProvider);
+	NSArray *components = [self componentsOfCleartextPath:cleartextPath];
+	if (components.count == 0) {
+		// the root directory has no node of its own, its directory stands in for it:
+		return [self ciphertextDirectoryPathForDirectoryId:@"" error:error];
+	}
+	NSArray *parentComponents = [components subarrayWithRange:NSMakeRange(0, components.count - 1)];
+	NSString *parentDirectoryId = [self directoryIdForCleartextPathComponents:parentComponents directoryIdProvider:directoryIdProvider error:error];
+	if (!parentDirectoryId) {
+		return nil;
+	}
+	return [self ciphertextPathForName:components.lastObject insideDirectoryWithId:parentDirectoryId directoryNode:NO error:error];
+}
+
+- (void)invalidateResolvedPathsWithPrefix:(NSString *)cleartextPath {
+	NSParameterAssert(cleartextPath);
+	NSArray *components = [self componentsOfCleartextPath:cleartextPath];
+	if (components.count == 0) {
+		[self.resolvedDirectoryIds removeAllObjects];
+		return;
+	}
+	NSString *invalidatedPath = [self cleartextPathWithComponents:components];
+	NSString *invalidatedPathPrefix = [invalidatedPath stringByAppendingString:@"/"];
+	[self.resolvedDirectoryIds removeObjectsPassingTest:^BOOL(NSString *path, NSString *directoryId) {
+		return [path isEqualToString:invalidatedPath] || [path hasPrefix:invalidatedPathPrefix];
+	}];
+}
+
+- (NSString *)directoryIdForCleartextPathComponents:(NSArray *)components directoryIdProvider:(SETOCryptorDirectoryIdProvider)directoryIdProvider error:(NSError **)error {
+	// start at the deepest directory that has been resolved before, the root directory has an empty ID:
+	NSString *directoryId = @"";
+	NSUInteger resolvedCount = 0;
+	for (NSUInteger count = components.count; count > 0; count--) {
+		NSString *path = [self cleartextPathWithComponents:[components subarrayWithRange:NSMakeRange(0, count)]];
+		NSString *resolvedDirectoryId = [self.resolvedDirectoryIds objectForKey:path];
+		if (resolvedDirectoryId) {
+			directoryId = resolvedDirectoryId;
+			resolvedCount = count;
+			break;
+		}
+	}
+
+	// resolve remaining directories:
+	for (NSUInteger i = resolvedCount; i < components.count; i++) {
+		NSString *nodePath = [self ciphertextPathForName:components[i] insideDirectoryWithId:directoryId directoryNode:YES error:error];
+		if (!nodePath) {
+			return nil;
+		}
+		NSError *providerError;
+		NSString *childDirectoryId = directoryIdProvider(nodePath, &providerError);
+		if (!childDirectoryId) {
+			if (error) {
+				*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDirectoryIdLookupFailedError userInfo:providerError ? @{NSUnderlyingErrorKey: providerError} : nil];
+			}
+			return nil;
+		}
+		directoryId = childDirectoryId;
+		NSString *path = [self cleartextPathWithComponents:[components subarrayWithRange:NSMakeRange(0, i + 1)]];
+		[self.resolvedDirectoryIds setObject:directoryId forKey:path];
+	}
+	return directoryId;
+}
+
+- (NSString *)ciphertextDirectoryPathForDirectoryId:(NSString *)directoryId error:(NSError **)error {
+	NSString *encryptedDirectoryId = [self encryptDirectoryId:directoryId];
+	if (encryptedDirectoryId.length <= 2) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+		}
+		return nil;
+	}
+	return [NSString stringWithFormat:@"d/%@/%@", [encryptedDirectoryId substringToIndex:2], [encryptedDirectoryId substringFromIndex:2]];
+}
+
+- (NSString *)ciphertextPathForName:(NSString *)name insideDirectoryWithId:(NSString *)directoryId directoryNode:(BOOL)directoryNode error:(NSError **)error {
+	NSString *directoryPath = [self ciphertextDirectoryPathForDirectoryId:directoryId error:error];
+	if (!directoryPath) {
+		return nil;
+	}
+	NSString *encryptedName = [self encryptFilename:name insideDirectoryWithId:directoryId];
+	if (!encryptedName) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+		}
+		return nil;
+	}
+	NSString *nodeName = directoryNode ? [self ciphertextDirectoryNodeNameForEncryptedFilename:encryptedName] : [self ciphertextNodeNameForEncryptedFilename:encryptedName];
+	return [directoryPath stringByAppendingPathComponent:nodeName];
+}
+
+- (NSString *)ciphertextNodeNameForEncryptedFilename:(NSString *)encryptedFilename {
+	return encryptedFilename;
+}
+
+- (NSString *)ciphertextDirectoryNodeNameForEncryptedFilename:(NSString *)encryptedFilename {
+	// up to vault version 5, directory nodes are files with the encrypted name prefixed by 0:
+	return [@"0" stringByAppendingString:encryptedFilename];
+}
+
+- (NSArray *)componentsOfCleartextPath:(NSString *)cleartextPath {
+	NSMutableArray *components = [NSMutableArray array];
+	for (NSString *component in [cleartextPath componentsSeparatedByString:@"/"]) {
+		if (component.length > 0) {
+			[components addObject:component];
+		}
+	}
+	return components;
+}
+
+- (NSString *)cleartextPathWithComponents:(NSArray *)components {
+	return [@"/" stringByAppendingString:[components componentsJoinedByString:@"/"]];
+}
+
 #pragma mark - File Content Encryption and Decryption
 
 - (void)authenticateFileAtPath:(NSString *)path callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback {
@@ -57,6 +249,50 @@ NSString *const kSETOCryptorErrorDomain = @"SETOCryptorErrorDomain";
 	NSAssert(NO, @"Overwrite this method.");
 }
 
+#pragma mark - Random Access File Content Encryption and Decryption
+
+- (NSData *)decryptRange:(NSRange)range ofFileAtPath:(NSString *)path error:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)path atOffset:(NSUInteger)offset error:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return NO;
+}
+
+- (BOOL)appendData:(NSData *)data toFileAtPath:(NSString *)path error:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return NO;
+}
+
+- (BOOL)truncateFileAtPath:(NSString *)path toCleartextSize:(NSUInteger)size error:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return NO;
+}
+
+#pragma mark - Streaming File Content Encryption and Decryption
+
+- (SETOFileContentEncryptor *)fileContentEncryptorWithError:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+- (SETOFileContentDecryptor *)fileContentDecryptorWithSource:(SETOCryptorReadCallback)source error:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+- (SETOFileContentDecryptor *)fileContentDecryptorWithInputStream:(NSInputStream *)inputStream error:(NSError **)error {
+	NSParameterAssert(inputStream);
+	if (inputStream.streamStatus == NSStreamStatusNotOpen) {
+		[inputStream open];
+	}
+	return [self fileContentDecryptorWithSource:^NSInteger(uint8_t *buffer, NSUInteger maxLength) {
+		return [inputStream read:buffer maxLength:maxLength];
+	} error:error];
+}
+
 #pragma mark - File Size Calculation
 
 - (NSUInteger)ciphertextSizeFromCleartextSize:(NSUInteger)cleartextSize {
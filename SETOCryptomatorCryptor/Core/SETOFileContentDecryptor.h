@@ -0,0 +1,29 @@
+//
+//  SETOFileContentDecryptor.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  @c SETOFileContentDecryptor decrypts file content incrementally from an arbitrary byte source, e.g. to decrypt a download while it arrives. Ciphertext is pulled from the source chunk by chunk, so no more than a single chunk is held in memory. The file header and every chunk are authenticated before their cleartext is returned.
+ *
+ *  Use -[SETOCryptor fileContentDecryptorWithSource:error:] or -[SETOCryptor fileContentDecryptorWithInputStream:error:] to create a decryptor. A decryptor must not be used by more than one thread at a time.
+ *
+ *  @note The file format cannot tell whether the source ended prematurely at a chunk boundary. Compare the number of decrypted bytes to the expected cleartext size if the source may be truncated.
+ */
+@interface SETOFileContentDecryptor : NSObject
+
+/**
+ *  Reads, authenticates and decrypts the next chunk from the source. The file header is read on first use.
+ *
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return The cleartext of the next chunk, empty data once the end of the source has been reached, or @p nil if an error occurred. After an error, the decryptor cannot be used anymore.
+ */
+- (NSData *)readChunkWithError:(NSError **)error;
+
+@end
@@ -0,0 +1,62 @@
+//
+//  SETOFileContentDecryptor.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentDecryptor.h"
+#import "SETOFileContentDecryptor_Private.h"
+
+@implementation SETOFileContentDecryptor
+
+#pragma mark - Initialization
+
+- (instancetype)initWithSource:(SETOCryptorReadCallback)source {
+	NSParameterAssert(source);
+	if (self = [super init]) {
+		self.source = source;
+		self.fileKey = [NSMutableData dataWithLength:32];
+	}
+	return self;
+}
+
+- (void)dealloc {
+	memset_s(self.fileKey.mutableBytes, self.fileKey.length, 0, self.fileKey.length);
+}
+
+#pragma mark - Streaming File Content Decryption
+
+- (NSData *)readChunkWithError:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+#pragma mark - Internal
+
+- (NSInteger)readBytes:(unsigned char *)buffer length:(NSUInteger)length {
+	// sources may return less than requested before their end:
+	NSUInteger bytesRead = 0;
+	while (bytesRead < length) {
+		NSInteger result = self.source(buffer + bytesRead, length - bytesRead);
+		if (result < 0) {
+			return -1;
+		} else if (result == 0) {
+			break;
+		}
+		bytesRead += result;
+	}
+	return bytesRead;
+}
+
+- (NSData *)failWithCode:(SETOCryptorError)code error:(NSError **)error {
+	self.failed = YES;
+	memset_s(self.fileKey.mutableBytes, self.fileKey.length, 0, self.fileKey.length);
+	if (error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:code userInfo:nil];
+	}
+	return nil;
+}
+
+@end
@@ -0,0 +1,33 @@
+//
+//  SETOFileContentDecryptor_Private.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentDecryptor.h"
+#import "SETOCryptor.h"
+
+/**
+ *  Source handling and failure state shared by the version specific decryptors.
+ */
+@interface SETOFileContentDecryptor ()
+
+@property (nonatomic, copy) SETOCryptorReadCallback source;
+@property (nonatomic, strong) NSMutableData *fileKey;
+@property (nonatomic, assign) BOOL failed;
+
+- (instancetype)initWithSource:(SETOCryptorReadCallback)source;
+
+/**
+ *  Reads from the source until @p length bytes have been read or the source has ended. Returns the number of bytes read or @c -1 if the source failed.
+ */
+- (NSInteger)readBytes:(unsigned char *)buffer length:(NSUInteger)length;
+
+/**
+ *  Marks the decryptor as failed, wipes the file key and returns @p nil after setting @p error.
+ */
+- (NSData *)failWithCode:(SETOCryptorError)code error:(NSError **)error;
+
+@end
@@ -0,0 +1,37 @@
+//
+//  SETOFileContentEncryptor.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  @c SETOFileContentEncryptor encrypts file content incrementally without any files involved, e.g. to stream ciphertext directly into an upload. Cleartext of arbitrary size is fed in piece by piece, ciphertext is returned as soon as the file header or a chunk is complete. Concatenating all returned ciphertext results in the same format as produced by -[SETOCryptor encryptFileAtPath:toPath:callback:progress:].
+ *
+ *  Use -[SETOCryptor fileContentEncryptorWithError:] to create an encryptor. An encryptor must not be used by more than one thread at a time.
+ */
+@interface SETOFileContentEncryptor : NSObject
+
+/**
+ *  Encrypts the next piece of cleartext.
+ *
+ *  @param data  The cleartext to append. May be of any size, including empty.
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return The ciphertext that became available, i.e. the file header on first use and every chunk completed by @p data. May be empty, since cleartext is buffered until a chunk is complete. @p nil if an error occurred.
+ */
+- (NSData *)updateWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ *  Finishes encryption. Afterwards, the encryptor cannot be used anymore.
+ *
+ *  @param error On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return The remaining ciphertext, i.e. the last partial chunk, or @p nil if an error occurred.
+ */
+- (NSData *)finishWithError:(NSError **)error;
+
+@end
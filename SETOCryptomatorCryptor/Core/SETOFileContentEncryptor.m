@@ -0,0 +1,23 @@
+//
+//  SETOFileContentEncryptor.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentEncryptor.h"
+
+@implementation SETOFileContentEncryptor
+
+- (NSData *)updateWithData:(NSData *)data error:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+- (NSData *)finishWithError:(NSError **)error {
+	NSAssert(NO, @"Overwrite this method.");
+	return nil;
+}
+
+@end
@@ -0,0 +1,37 @@
+//
+//  SETOFilenameMigrator.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "SETOCryptor.h"
+
+extern NSString *const kSETOFilenameMigratorErrorDomain;
+
+typedef NS_ENUM(NSInteger, SETOFilenameMigratorError) {
+	SETOFilenameMigratorCorruptedLongNameError
+};
+
+/**
+ *  @c SETOFilenameMigrator migrates the ciphertext names of a vault from version 5 and 6 to version 7. Both versions use the same AES-SIV ciphertext for names, so every name is only decoded from base32 and encoded as base64url. No master key is needed and nothing is encrypted or decrypted.
+ */
+@interface SETOFilenameMigrator : NSObject
+
+/**
+ *  Renames all nodes inside the @c d directory of a vault to the layout of vault version 7: files get the @c .c9r extension, directories and symlinks become directories containing a @c dir.c9r or @c symlink.c9r file and names longer than 220 characters are shortened to a @c .c9s directory. Long names of vault version 5 are read from the @c m directory, which is not needed anymore afterwards.
+ *
+ *  Directories are migrated concurrently. Each node is moved to its new place by a single rename as the last step, nodes that have already been migrated are skipped. If the migration is interrupted, it can be resumed by calling this method again.
+ *
+ *  The version of the master key file is not changed by this method.
+ *
+ *  @param path             Root path of the vault.
+ *  @param callback         Completion callback with an error object if the migration failed.
+ *  @param progressCallback Progress callback with the fraction of migrated directories, which may be called from any thread.
+ */
++ (void)migrateVaultAtPath:(NSString *)path callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback;
+
+@end
@@ -0,0 +1,193 @@
+//
+//  SETOFilenameMigrator.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFilenameMigrator.h"
+
+#import "NSData+SETOBase32Encoding.h"
+#import "NSData+SETOBase64urlEncoding.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+NSString *const kSETOFilenameMigratorErrorDomain = @"SETOFilenameMigratorErrorDomain";
+NSUInteger const kSETOFilenameMigratorV7ShorteningThreshold = 220;
+
+@implementation SETOFilenameMigrator
+
++ (void)migrateVaultAtPath:(NSString *)path callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback {
+	NSParameterAssert(path);
+	NSParameterAssert(callback);
+
+	// collect ciphertext directories, which are two levels below d:
+	NSError *error;
+	NSArray *directoryPaths = [self ciphertextDirectoryPathsOfVaultAtPath:path error:&error];
+	if (!directoryPaths) {
+		callback(error);
+		return;
+	}
+
+	// init progress:
+	if (progressCallback) {
+		progressCallback(0.0);
+	}
+
+	// migrate directories concurrently, each directory is only touched by one worker:
+	NSUInteger directoryCount = directoryPaths.count;
+	__block NSUInteger migratedDirectoryCount = 0;
+	__block NSError *migrationError;
+	NSObject *lock = [[NSObject alloc] init];
+	dispatch_apply(directoryCount, dispatch_get_global_queue(qos_class_self(), 0), ^(size_t i) {
+		@synchronized(lock) {
+			if (migrationError) {
+				return;
+			}
+		}
+		NSError *directoryError;
+		BOOL success = [self migrateDirectoryAtPath:directoryPaths[i] vaultPath:path error:&directoryError];
+		@synchronized(lock) {
+			if (!success) {
+				migrationError = migrationError ?: directoryError;
+				return;
+			}
+			migratedDirectoryCount++;
+			if (progressCallback) {
+				progressCallback((CGFloat)migratedDirectoryCount / directoryCount);
+			}
+		}
+	});
+	if (migrationError) {
+		callback(migrationError);
+		return;
+	}
+
+	// done:
+	if (progressCallback) {
+		progressCallback(1.0);
+	}
+	callback(nil);
+}
+
++ (NSArray *)ciphertextDirectoryPathsOfVaultAtPath:(NSString *)path error:(NSError **)error {
+	NSFileManager *fileManager = [NSFileManager defaultManager];
+	NSString *dataPath = [path stringByAppendingPathComponent:@"d"];
+	NSArray *parentNames = [fileManager contentsOfDirectoryAtPath:dataPath error:error];
+	if (!parentNames) {
+		return nil;
+	}
+	NSMutableArray *directoryPaths = [NSMutableArray array];
+	for (NSString *parentName in parentNames) {
+		NSString *parentPath = [dataPath stringByAppendingPathComponent:parentName];
+		BOOL isDirectory = NO;
+		if (![fileManager fileExistsAtPath:parentPath isDirectory:&isDirectory] || !isDirectory) {
+			continue;
+		}
+		NSArray *directoryNames = [fileManager contentsOfDirectoryAtPath:parentPath error:error];
+		if (!directoryNames) {
+			return nil;
+		}
+		for (NSString *directoryName in directoryNames) {
+			NSString *directoryPath = [parentPath stringByAppendingPathComponent:directoryName];
+			if ([fileManager fileExistsAtPath:directoryPath isDirectory:&isDirectory] && isDirectory) {
+				[directoryPaths addObject:directoryPath];
+			}
+		}
+	}
+	return directoryPaths;
+}
+
++ (BOOL)migrateDirectoryAtPath:(NSString *)directoryPath vaultPath:(NSString *)vaultPath error:(NSError **)error {
+	NSArray *nodeNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:directoryPath error:error];
+	if (!nodeNames) {
+		return NO;
+	}
+	for (NSString *nodeName in nodeNames) {
+		@autoreleasepool {
+			if (![self migrateNodeWithName:nodeName insideDirectoryAtPath:directoryPath vaultPath:vaultPath error:error]) {
+				return NO;
+			}
+		}
+	}
+	return YES;
+}
+
++ (BOOL)migrateNodeWithName:(NSString *)nodeName insideDirectoryAtPath:(NSString *)directoryPath vaultPath:(NSString *)vaultPath error:(NSError **)error {
+	// resolve long name from its metadata file:
+	NSString *v5Name = nodeName;
+	if ([nodeName hasSuffix:@".lng"]) {
+		v5Name = [self longNameForShortName:nodeName vaultPath:vaultPath error:error];
+		if (!v5Name) {
+			return NO;
+		}
+	}
+
+	// determine node type by its prefix, the base32 alphabet contains neither 0 nor 1:
+	NSString *encodedName = v5Name;
+	NSString *v7NodeFileName = nil;
+	if ([v5Name hasPrefix:@"0"]) {
+		encodedName = [v5Name substringFromIndex:1];
+		v7NodeFileName = @"dir.c9r";
+	} else if ([v5Name hasPrefix:@"1S"]) {
+		encodedName = [v5Name substringFromIndex:2];
+		v7NodeFileName = @"symlink.c9r";
+	}
+
+	// nodes that are not valid in vault version 5, including nodes that have already been migrated, are skipped:
+	NSData *ciphertext = [NSData seto_dataWithBase32EncodedString:encodedName];
+	if (ciphertext.length <= 16) {
+		return YES;
+	}
+
+	// re-encode, shorten if necessary:
+	NSString *v7Name = [[ciphertext seto_base64urlEncodedString] stringByAppendingString:@".c9r"];
+	NSString *v7Path = [directoryPath stringByAppendingPathComponent:v7Name];
+	NSFileManager *fileManager = [NSFileManager defaultManager];
+	if (v7Name.length > kSETOFilenameMigratorV7ShorteningThreshold) {
+		NSData *v7NameData = [v7Name dataUsingEncoding:NSUTF8StringEncoding];
+		unsigned char hashedName[CC_SHA1_DIGEST_LENGTH];
+		CC_SHA1(v7NameData.bytes, (CC_LONG)v7NameData.length, hashedName);
+		NSString *shortName = [[[NSData dataWithBytes:hashedName length:sizeof(hashedName)] seto_base64urlEncodedString] stringByAppendingString:@".c9s"];
+		v7Path = [directoryPath stringByAppendingPathComponent:shortName];
+		if (![fileManager createDirectoryAtPath:v7Path withIntermediateDirectories:YES attributes:nil error:error] || ![v7NameData writeToFile:[v7Path stringByAppendingPathComponent:@"name.c9s"] options:NSDataWritingAtomic error:error]) {
+			return NO;
+		}
+		v7NodeFileName = v7NodeFileName ?: @"contents.c9r";
+	} else if (v7NodeFileName && ![fileManager createDirectoryAtPath:v7Path withIntermediateDirectories:YES attributes:nil error:error]) {
+		return NO;
+	}
+
+	// moving the node is the last step, so an interrupted migration can be resumed:
+	NSString *nodePath = [directoryPath stringByAppendingPathComponent:nodeName];
+	NSString *targetPath = v7NodeFileName ? [v7Path stringByAppendingPathComponent:v7NodeFileName] : v7Path;
+	return [fileManager moveItemAtPath:nodePath toPath:targetPath error:error];
+}
+
++ (NSString *)longNameForShortName:(NSString *)shortName vaultPath:(NSString *)vaultPath error:(NSError **)error {
+	if (shortName.length < 4) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOFilenameMigratorErrorDomain code:SETOFilenameMigratorCorruptedLongNameError userInfo:nil];
+		}
+		return nil;
+	}
+	NSString *metadataPath = [vaultPath stringByAppendingPathComponent:@"m"];
+	metadataPath = [metadataPath stringByAppendingPathComponent:[shortName substringToIndex:2]];
+	metadataPath = [metadataPath stringByAppendingPathComponent:[shortName substringWithRange:NSMakeRange(2, 2)]];
+	metadataPath = [metadataPath stringByAppendingPathComponent:shortName];
+	NSData *metadata = [NSData dataWithContentsOfFile:metadataPath options:0 error:error];
+	if (!metadata) {
+		return nil;
+	}
+	NSString *longName = [[NSString alloc] initWithData:metadata encoding:NSUTF8StringEncoding];
+	if (!longName) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOFilenameMigratorErrorDomain code:SETOFilenameMigratorCorruptedLongNameError userInfo:nil];
+		}
+		return nil;
+	}
+	return longName;
+}
+
+@end
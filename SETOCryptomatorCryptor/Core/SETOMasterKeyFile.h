@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 
 @class SETOMasterKey;
+@class SETOScryptContext;
 
 extern NSString *const kSETOMasterKeyFileErrorDomain;
 
@@ -21,6 +22,7 @@ typedef NS_ENUM(NSInteger, SETOMasterKeyFileError) {
 };
 
 extern uint64_t const kSETOMasterKeyFileDefaultScryptCostParam;
+extern uint32_t const kSETOMasterKeyFileDefaultScryptParallelization;
 
 @interface SETOMasterKeyFile : NSObject
 
@@ -53,6 +55,19 @@ extern uint64_t const kSETOMasterKeyFileDefaultScryptCostParam;
  */
 - (SETOMasterKey *)unlockWithPassphrase:(NSString *)passphrase pepper:(NSData *)pepper error:(NSError **)error;
 
+/**
+ *  Derives a KEK from the given passphrase and the params from this master key file using scrypt and unwraps the stored encryption and MAC keys.
+ *  The working memory of scrypt is taken from the given context, which should be reused for repeated unlocks.
+ *
+ *  @param passphrase    The passphrase used during key derivation.
+ *  @param pepper        An application-specific pepper added to the scrypt's salt (if applicable).
+ *  @param scryptContext The context that keeps the working memory of scrypt. If @p nil, the memory is allocated for this unlock only.
+ *  @param error         On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return A master key with the unwrapped keys.
+ */
+- (SETOMasterKey *)unlockWithPassphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptContext:(SETOScryptContext *)scryptContext error:(NSError **)error;
+
 /**
  *  Derives a KEK from the given passphrase and wraps the key material from master key.
  *  Then serializes the encrypted keys as well as used key derivation parameters into a JSON representation that can be stored into a master key file.
@@ -68,4 +83,34 @@ extern uint64_t const kSETOMasterKeyFileDefaultScryptCostParam;
  */
 + (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam error:(NSError **)error;
 
+/**
+ *  Derives a KEK from the given passphrase and wraps the key material from master key.
+ *  Then serializes the encrypted keys as well as used key derivation parameters into a JSON representation that can be stored into a master key file.
+ *
+ *  The independent scrypt lanes are computed on multiple threads, so raising the parallelization increases the total work of the key derivation without increasing the unlock time on multi-core devices. Each thread needs its own scrypt memory (128 * 8 * @p scryptCostParam bytes). The parallelization is only stored if it is greater than 1, so master key files created with 1 remain readable by implementations that do not know this parameter.
+ *
+ *  @param masterKey             The key to protect.
+ *  @param vaultVersion          The vault version that should be stored in this master key file (for downwards compatibility).
+ *  @param passphrase            The passphrase used during key derivation.
+ *  @param pepper                An application-specific pepper added to the scrypt's salt (if applicable).
+ *  @param scryptCostParam       The work factor for the key derivation function (scrypt). Use @p kSETOMasterKeyFileDefaultScryptCostParam if you are not sure.
+ *  @param scryptParallelization The parallelization parameter for the key derivation function (scrypt), must be greater than 0. Use @p kSETOMasterKeyFileDefaultScryptParallelization if you are not sure.
+ *  @param error                 On input, a pointer to an error object. If an error occurs, this pointer is set to an actual error object containing the error information. You may specify @p NULL for this parameter if you do not want the error information.
+ *
+ *  @return A JSON representation of the encrypted master key with its key derivation parameters.
+ */
++ (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam scryptParallelization:(uint32_t)scryptParallelization error:(NSError **)error;
+
+/**
+ *  Benchmarks scrypt on the current device and determines the largest cost param (a power of 2) whose key derivation fits into the given duration and memory limit. The result is never lower than @p kSETOMasterKeyFileDefaultScryptCostParam, even on slow devices or for short durations.
+ *  The benchmark derives keys with increasing cost params and stops before the target duration would be exceeded, so it takes up to about twice the given duration. You should call it from a background thread and store the result, as it may vary between runs.
+ *
+ *  @param duration              The maximum time an unlock should take, in seconds.
+ *  @param memoryLimit           The maximum number of bytes scrypt may allocate, which is 1024 * @p scryptCostParam bytes for each lane.
+ *  @param scryptParallelization The parallelization parameter that will be passed to the lock method. Use @p kSETOMasterKeyFileDefaultScryptParallelization if you are not sure.
+ *
+ *  @return The calibrated cost param that can be passed to the lock method, or 0 if @p kSETOMasterKeyFileDefaultScryptCostParam does not fit into the memory limit.
+ */
++ (uint64_t)calibratedScryptCostParamForDuration:(NSTimeInterval)duration memoryLimit:(uint64_t)memoryLimit scryptParallelization:(uint32_t)scryptParallelization;
+
 @end
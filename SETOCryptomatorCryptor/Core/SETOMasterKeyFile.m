@@ -8,6 +8,8 @@
 
 #import "SETOMasterKeyFile.h"
 #import "SETOMasterKey.h"
+#import "SETOScryptContext.h"
+#import "SETOScryptContext_Private.h"
 
 #import "SETOCryptoSupport.h"
 #import "SETOSecureRandom.h"
@@ -26,18 +28,21 @@ NSString *const kSETOMasterKeyFileVersionMacKey = @"versionMac";
 NSString *const kSETOMasterKeyFileScryptSaltKey = @"scryptSalt";
 NSString *const kSETOMasterKeyFileScryptCostParamKey = @"scryptCostParam";
 NSString *const kSETOMasterKeyFileScryptBlockSizeKey = @"scryptBlockSize";
+NSString *const kSETOMasterKeyFileScryptParallelizationKey = @"scryptParallelization";
 NSString *const kSETOMasterKeyFilePrimaryMasterKeyKey = @"primaryMasterKey";
 NSString *const kSETOMasterKeyFileMacMasterKeyKey = @"hmacMasterKey";
 
 uint64_t const kSETOMasterKeyFileDefaultScryptCostParam = 32768; // 2^15
 int const kSETOMasterKeyFileDefaultScryptSaltSize = 8;
 uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
+uint32_t const kSETOMasterKeyFileDefaultScryptParallelization = 1;
 
 @interface SETOMasterKeyFile ()
 @property (nonatomic, assign) uint32_t version;
 @property (nonatomic, strong) NSData *scryptSalt;
 @property (nonatomic, assign) uint64_t scryptCostParam;
 @property (nonatomic, assign) uint32_t scryptBlockSize;
+@property (nonatomic, assign) uint32_t scryptParallelization;
 @property (nonatomic, strong) NSData *primaryMasterKey;
 @property (nonatomic, strong) NSData *macMasterKey;
 @property (nonatomic, strong) NSData *versionMac;
@@ -58,6 +63,7 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 				kSETOMasterKeyFileScryptSaltKey: KZCall(dataFromBase64EncodedString:, scryptSalt),
 				kSETOMasterKeyFileScryptCostParamKey: KZProperty(scryptCostParam),
 				kSETOMasterKeyFileScryptBlockSizeKey: KZProperty(scryptBlockSize),
+				kSETOMasterKeyFileScryptParallelizationKey: KZProperty(scryptParallelization),
 				kSETOMasterKeyFilePrimaryMasterKeyKey: KZCall(dataFromBase64EncodedString:, primaryMasterKey),
 				kSETOMasterKeyFileMacMasterKeyKey: KZCall(dataFromBase64EncodedString:, macMasterKey),
 				kSETOMasterKeyFileVersionMacKey: KZCall(dataFromBase64EncodedString:, versionMac)
@@ -70,6 +76,10 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 }
 
 - (SETOMasterKey *)unlockWithPassphrase:(NSString *)passphrase pepper:(NSData *)pepper error:(NSError **)error {
+	return [self unlockWithPassphrase:passphrase pepper:pepper scryptContext:nil error:error];
+}
+
+- (SETOMasterKey *)unlockWithPassphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptContext:(SETOScryptContext *)scryptContext error:(NSError **)error {
 	NSParameterAssert(passphrase);
 	if (!self.primaryMasterKey || !self.macMasterKey || (self.version >= 5 && !self.versionMac)) {
 		if (error) {
@@ -94,8 +104,16 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 	}
 	uint64_t costParam = self.scryptCostParam;
 	uint32_t blockSize = (uint32_t)self.scryptBlockSize;
+	// master key files without parallelization have been created with 1:
+	uint32_t parallelization = MAX(self.scryptParallelization, kSETOMasterKeyFileDefaultScryptParallelization);
 	unsigned char kekBytes[kCCKeySizeAES256];
-	if (crypto_scrypt(passphraseData.bytes, passphraseData.length, saltAndPepper.bytes, saltAndPepper.length, costParam, blockSize, 1, kekBytes, sizeof(kekBytes)) == -1) {
+	int scryptResult;
+	if (scryptContext) {
+		scryptResult = crypto_scrypt_ctx(scryptContext.ctx, passphraseData.bytes, passphraseData.length, saltAndPepper.bytes, saltAndPepper.length, costParam, blockSize, parallelization, kekBytes, sizeof(kekBytes));
+	} else {
+		scryptResult = crypto_scrypt(passphraseData.bytes, passphraseData.length, saltAndPepper.bytes, saltAndPepper.length, costParam, blockSize, parallelization, kekBytes, sizeof(kekBytes));
+	}
+	if (scryptResult == -1) {
 		if (error) {
 			*error = [NSError errorWithDomain:kSETOMasterKeyFileErrorDomain code:SETOMasterKeyFileKeyDerivationFailedError userInfo:nil];
 		}
@@ -148,12 +166,17 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 }
 
 + (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam error:(NSError **)error {
-	return [SETOMasterKeyFile lockMasterKey:masterKey withVaultVersion:vaultVersion passphrase:passphrase pepper:pepper scryptCostParam:scryptCostParam secureRandom:[SETOSecureRandom sharedInstance] error:error];
+	return [SETOMasterKeyFile lockMasterKey:masterKey withVaultVersion:vaultVersion passphrase:passphrase pepper:pepper scryptCostParam:scryptCostParam scryptParallelization:kSETOMasterKeyFileDefaultScryptParallelization error:error];
 }
 
-+ (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam secureRandom:(SETOSecureRandom *)secureRandom error:(NSError **)error {
++ (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam scryptParallelization:(uint32_t)scryptParallelization error:(NSError **)error {
+	return [SETOMasterKeyFile lockMasterKey:masterKey withVaultVersion:vaultVersion passphrase:passphrase pepper:pepper scryptCostParam:scryptCostParam scryptParallelization:scryptParallelization secureRandom:[SETOSecureRandom sharedInstance] error:error];
+}
+
++ (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam scryptParallelization:(uint32_t)scryptParallelization secureRandom:(SETOSecureRandom *)secureRandom error:(NSError **)error {
 	NSParameterAssert(masterKey);
 	NSParameterAssert(passphrase);
+	NSParameterAssert(scryptParallelization > 0);
 	if ([NSThread isMainThread]) {
 		NSLog(@"Warning: +[SETOMasterKeyFile lockMasterKey:withVaultVersion:passphrase:pepper:error:] should be called from a background thread, as random number generation will benefit from UI interaction.");
 	}
@@ -189,7 +212,7 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 		passphraseData = [passphrase dataUsingEncoding:NSUTF8StringEncoding];
 	}
 	unsigned char kekBytes[kCCKeySizeAES256];
-	if (crypto_scrypt(passphraseData.bytes, passphraseData.length, saltAndPepper.bytes, saltAndPepper.length, scryptCostParam, kSETOMasterKeyFileDefaultScryptBlockSize, 1, kekBytes, sizeof(kekBytes)) == -1) {
+	if (crypto_scrypt(passphraseData.bytes, passphraseData.length, saltAndPepper.bytes, saltAndPepper.length, scryptCostParam, kSETOMasterKeyFileDefaultScryptBlockSize, scryptParallelization, kekBytes, sizeof(kekBytes)) == -1) {
 		if (error) {
 			*error = [NSError errorWithDomain:kSETOMasterKeyFileErrorDomain code:SETOMasterKeyFileKeyDerivationFailedError userInfo:nil];
 		}
@@ -228,6 +251,7 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 	masterKeyFile.scryptSalt = salt;
 	masterKeyFile.scryptCostParam = scryptCostParam;
 	masterKeyFile.scryptBlockSize = kSETOMasterKeyFileDefaultScryptBlockSize;
+	masterKeyFile.scryptParallelization = scryptParallelization;
 	masterKeyFile.primaryMasterKey = wrappedPrimaryMasterKey;
 	masterKeyFile.macMasterKey = wrappedMacMasterKey;
 	masterKeyFile.versionMac = [NSData dataWithBytes:versionMac length:sizeof(versionMac)];
@@ -244,6 +268,41 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 	return jsonData;
 }
 
+#pragma mark - Scrypt Calibration
+
++ (uint64_t)calibratedScryptCostParamForDuration:(NSTimeInterval)duration memoryLimit:(uint64_t)memoryLimit scryptParallelization:(uint32_t)scryptParallelization {
+	NSParameterAssert(scryptParallelization > 0);
+	// memory is estimated conservatively, as if all lanes ran at once:
+	uint64_t bytesPerCostParam = 128 * (uint64_t)kSETOMasterKeyFileDefaultScryptBlockSize * scryptParallelization;
+	unsigned char passphrase[16] = {0};
+	unsigned char salt[8] = {0};
+	unsigned char kekBytes[kCCKeySizeAES256];
+
+	// the default cost param is the lower bound, even if it takes longer than the given duration:
+	uint64_t maxCostParam = memoryLimit / bytesPerCostParam;
+	if (maxCostParam < kSETOMasterKeyFileDefaultScryptCostParam) {
+		return 0;
+	}
+
+	// double cost param as long as the measured key derivation fits, the time roughly doubles with it:
+	uint64_t calibratedCostParam = kSETOMasterKeyFileDefaultScryptCostParam;
+	for (uint64_t costParam = kSETOMasterKeyFileDefaultScryptCostParam; costParam <= maxCostParam; costParam *= 2) {
+		CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+		if (crypto_scrypt(passphrase, sizeof(passphrase), salt, sizeof(salt), costParam, kSETOMasterKeyFileDefaultScryptBlockSize, scryptParallelization, kekBytes, sizeof(kekBytes)) == -1) {
+			break;
+		}
+		CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+		if (elapsed > duration) {
+			break;
+		}
+		calibratedCostParam = costParam;
+		if (elapsed * 2 > duration || costParam > UINT64_MAX / 2) {
+			break;
+		}
+	}
+	return calibratedCostParam;
+}
+
 #pragma mark - RFC 3394 Key Wrap
 
 + (NSData *)wrapKey:(NSData *)rawKey kek:(unsigned char *)kekBytes error:(NSError **)error {
@@ -292,7 +351,7 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 #pragma mark - Convenience
 
 - (NSDictionary *)dictionaryRepresentation {
-	return @{
+	NSMutableDictionary *dictionaryRepresentation = [@{
 		kSETOMasterKeyFileVersionKey: @(self.version),
 		kSETOMasterKeyFileVersionMacKey: [self.versionMac base64EncodedStringWithOptions:0],
 		kSETOMasterKeyFileScryptSaltKey: [self.scryptSalt base64EncodedStringWithOptions:0],
@@ -300,7 +359,12 @@ uint32_t const kSETOMasterKeyFileDefaultScryptBlockSize = 8;
 		kSETOMasterKeyFileScryptBlockSizeKey: @(self.scryptBlockSize),
 		kSETOMasterKeyFilePrimaryMasterKeyKey: [self.primaryMasterKey base64EncodedStringWithOptions:0],
 		kSETOMasterKeyFileMacMasterKeyKey: [self.macMasterKey base64EncodedStringWithOptions:0]
-	};
+	} mutableCopy];
+	// parallelization is omitted if it is 1, so the master key file stays compatible:
+	if (self.scryptParallelization > kSETOMasterKeyFileDefaultScryptParallelization) {
+		dictionaryRepresentation[kSETOMasterKeyFileScryptParallelizationKey] = @(self.scryptParallelization);
+	}
+	return dictionaryRepresentation;
 }
 
 - (NSData *)dataFromBase64EncodedString:(NSString *)base64EncodedString {
@@ -0,0 +1,25 @@
+//
+//  SETOScryptContext.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  @c SETOScryptContext keeps the working memory of scrypt (about 32 MiB with default parameters) across key derivations, so that repeated unlocks do not pay for allocating and faulting in that memory every time. The memory is allocated on first use, grown if a master key file requires more of it and zeroed after each key derivation. It is released when the context is deallocated.
+ *
+ *  A context can be shared between threads, but key derivations using the same context are serialized.
+ */
+@interface SETOScryptContext : NSObject
+
+/**
+ *  Creates a scrypt context without any working memory.
+ *
+ *  @return New scrypt context instance or @p nil if it could not be created.
+ */
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+
+@end
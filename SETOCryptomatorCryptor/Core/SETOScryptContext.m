@@ -0,0 +1,30 @@
+//
+//  SETOScryptContext.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOScryptContext.h"
+#import "SETOScryptContext_Private.h"
+
+#import "crypto_scrypt.h"
+
+@implementation SETOScryptContext
+
+- (instancetype)init {
+	if (self = [super init]) {
+		self.ctx = crypto_scrypt_ctx_init();
+		if (!self.ctx) {
+			return nil;
+		}
+	}
+	return self;
+}
+
+- (void)dealloc {
+	crypto_scrypt_ctx_free(self.ctx);
+}
+
+@end
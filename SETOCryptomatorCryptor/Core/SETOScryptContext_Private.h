@@ -0,0 +1,20 @@
+//
+//  SETOScryptContext_Private.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOScryptContext.h"
+
+struct crypto_scrypt_ctx;
+
+/**
+ *  Working memory of @c SETOScryptContext, shared with @c SETOMasterKeyFile for key derivation.
+ */
+@interface SETOScryptContext ()
+
+@property (nonatomic, assign) struct crypto_scrypt_ctx *ctx;
+
+@end
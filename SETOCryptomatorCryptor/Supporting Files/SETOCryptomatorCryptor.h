@@ -18,6 +18,11 @@ FOUNDATION_EXPORT const unsigned char SETOCryptomatorCryptorVersionString[];
 
 #import <SETOCryptomatorCryptor/SETOMasterKey.h>
 #import <SETOCryptomatorCryptor/SETOMasterKeyFile.h>
+#import <SETOCryptomatorCryptor/SETOScryptContext.h>
 #import <SETOCryptomatorCryptor/SETOCryptorProvider.h>
 #import <SETOCryptomatorCryptor/SETOCryptor.h>
 #import <SETOCryptomatorCryptor/SETOAsyncCryptor.h>
+#import <SETOCryptomatorCryptor/SETOFileContentEncryptor.h>
+#import <SETOCryptomatorCryptor/SETOFileContentDecryptor.h>
+#import <SETOCryptomatorCryptor/SETOFilenameMigrator.h>
+#import <SETOCryptomatorCryptor/SETOContentMigrator.h>
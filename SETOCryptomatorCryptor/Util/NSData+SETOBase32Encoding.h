@@ -0,0 +1,29 @@
+//
+//  NSData+SETOBase32Encoding.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@interface NSData (SETOBase32Encoding)
+
+/**
+ *  Validates and decodes a padded base32 string (RFC 4648) in a single pass. Letters are case-insensitive.
+ *
+ *  @param base32String Base32 string with a length that is a multiple of 8.
+ *
+ *  @return Decoded data or @p nil, if the string contains characters outside of the base32 alphabet or has an invalid length or padding.
+ */
++ (instancetype)seto_dataWithBase32EncodedString:(NSString *)base32String;
+
+/**
+ *  Encodes data as padded base32 string (RFC 4648) with uppercase letters.
+ *
+ *  @return Base32 string.
+ */
+- (NSString *)seto_base32EncodedString;
+
+@end
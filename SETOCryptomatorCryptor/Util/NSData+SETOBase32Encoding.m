@@ -0,0 +1,46 @@
+//
+//  NSData+SETOBase32Encoding.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "NSData+SETOBase32Encoding.h"
+
+#import "SETOBaseEncodingUtil.h"
+
+@implementation NSData (SETOBase32Encoding)
+
++ (instancetype)seto_dataWithBase32EncodedString:(NSString *)base32String {
+	NSUInteger length = base32String.length;
+
+	// get ascii characters without copying, if possible:
+	const char *chars = CFStringGetCStringPtr((__bridge CFStringRef)base32String, kCFStringEncodingASCII);
+	NSMutableData *charsBuffer;
+	if (!chars) {
+		charsBuffer = [NSMutableData dataWithLength:length + 1];
+		if (![base32String getCString:charsBuffer.mutableBytes maxLength:charsBuffer.length encoding:NSASCIIStringEncoding]) {
+			return nil;
+		}
+		chars = charsBuffer.bytes;
+	}
+
+	// decode and validate:
+	unsigned char *bytes = malloc(MAX(seto_base32_decoded_max_length(length), 1));
+	size_t decodedLength;
+	if (seto_base32_decode(chars, length, bytes, &decodedLength)) {
+		free(bytes);
+		return nil;
+	}
+	return [self dataWithBytesNoCopy:bytes length:decodedLength];
+}
+
+- (NSString *)seto_base32EncodedString {
+	size_t length = seto_base32_encoded_length(self.length);
+	char *chars = malloc(MAX(length, 1));
+	seto_base32_encode(self.bytes, self.length, chars);
+	return [[NSString alloc] initWithBytesNoCopy:chars length:length encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
+@end
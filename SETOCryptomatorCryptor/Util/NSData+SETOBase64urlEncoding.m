@@ -8,22 +8,39 @@
 
 #import "NSData+SETOBase64urlEncoding.h"
 
+#import "SETOBaseEncodingUtil.h"
+
 @implementation NSData (SETOBase64urlEncoding)
 
 + (instancetype)seto_dataWithBase64urlEncodedString:(NSString *)base64urlString {
-	NSString *base64String = [base64urlString stringByReplacingOccurrencesOfString:@"-" withString:@"+"];
-	base64String = [base64String stringByReplacingOccurrencesOfString:@"_" withString:@"/"];
-	return [[NSData alloc] initWithBase64EncodedString:base64String options:0];
+	NSUInteger length = base64urlString.length;
+
+	// get ascii characters without copying, if possible:
+	const char *chars = CFStringGetCStringPtr((__bridge CFStringRef)base64urlString, kCFStringEncodingASCII);
+	NSMutableData *charsBuffer;
+	if (!chars) {
+		charsBuffer = [NSMutableData dataWithLength:length + 1];
+		if (![base64urlString getCString:charsBuffer.mutableBytes maxLength:charsBuffer.length encoding:NSASCIIStringEncoding]) {
+			return nil;
+		}
+		chars = charsBuffer.bytes;
+	}
+
+	// decode and validate:
+	unsigned char *bytes = malloc(MAX(seto_base64url_decoded_max_length(length), 1));
+	size_t decodedLength;
+	if (seto_base64url_decode(chars, length, bytes, &decodedLength)) {
+		free(bytes);
+		return nil;
+	}
+	return [self dataWithBytesNoCopy:bytes length:decodedLength];
 }
 
 - (NSString *)seto_base64urlEncodedString {
-	if (!self.bytes) {
-		return [NSString string];
-	}
-	NSString *base64urlString = [self base64EncodedStringWithOptions:0];
-	base64urlString = [base64urlString stringByReplacingOccurrencesOfString:@"+" withString:@"-"];
-	base64urlString = [base64urlString stringByReplacingOccurrencesOfString:@"/" withString:@"_"];
-	return base64urlString;
+	size_t length = seto_base64url_encoded_length(self.length);
+	char *chars = malloc(MAX(length, 1));
+	seto_base64url_encode(self.bytes, self.length, chars);
+	return [[NSString alloc] initWithBytesNoCopy:chars length:length encoding:NSASCIIStringEncoding freeWhenDone:YES];
 }
 
 @end
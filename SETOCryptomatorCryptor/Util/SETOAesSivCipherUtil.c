@@ -7,11 +7,12 @@
 //
 
 #include "SETOAesSivCipherUtil.h"
-#include "SETOCryptoSupport.h"
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <openssl/cmac.h>
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
 
 static const size_t BLOCK_SIZE = 16;
@@ -43,17 +44,6 @@ void array_xor(const unsigned char *in1, const unsigned char *in2, unsigned char
 	}
 }
 
-void array_xorend(const unsigned char *in1, size_t in1_len, const unsigned char *in2, size_t in2_len, unsigned char *out) {
-	assert(in1_len >= in2_len);
-	long diff = in1_len - in2_len;
-	for (long i = 0; i < diff; i++) {
-		out[i] = in1[i];
-	}
-	for (long i = diff; i < in1_len; i++) {
-		out[i] = in1[i] ^ in2[i - diff];
-	}
-}
-
 void dbl(unsigned char *data, size_t len) {
 	assert(len == 16);
 	int carry = shift_left(data, 16);
@@ -68,171 +58,252 @@ size_t min(size_t a, size_t b) {
 	return a < b ? a : b;
 }
 
-int s2v(const unsigned char *mac_key, const size_t mac_key_len, const unsigned char *plaintext, const size_t plaintext_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
-	assert(mac_key_len == 16 || mac_key_len == 24 || mac_key_len == 32);
+struct siv_ctx {
+	EVP_CIPHER_CTX *ctr_ctx;
+	CMAC_CTX *cmac_ctx;
+	unsigned char d[16];
+};
 
-	const EVP_CIPHER *cipher;
-	switch (mac_key_len) {
+const EVP_CIPHER *ctr_cipher(const size_t key_len) {
+	switch (key_len) {
 		case 16:
-			cipher = EVP_aes_128_cbc();
-			break;
+			return EVP_aes_128_ctr();
 		case 24:
-			cipher = EVP_aes_192_cbc();
-			break;
+			return EVP_aes_192_ctr();
 		case 32:
-			cipher = EVP_aes_256_cbc();
-			break;
+			return EVP_aes_256_ctr();
 		default:
-			return -1;
+			return NULL;
 	}
+}
 
-	CMAC_CTX *ctx = CMAC_CTX_new();
-	CMAC_Init(ctx, mac_key, mac_key_len, cipher, NULL);
+const EVP_CIPHER *cbc_cipher(const size_t key_len) {
+	switch (key_len) {
+		case 16:
+			return EVP_aes_128_cbc();
+		case 24:
+			return EVP_aes_192_cbc();
+		case 32:
+			return EVP_aes_256_cbc();
+		default:
+			return NULL;
+	}
+}
 
-	const unsigned char zeros[BLOCK_SIZE] = {0};
-	unsigned char d[BLOCK_SIZE];
+/* First half of S2V: folds the associated data into the precomputed CMAC of the zero block */
+void s2v_cmac_ad(CMAC_CTX *ctx, const unsigned char *d0, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *d) {
 	size_t mac_size;
-
-	CMAC_Update(ctx, zeros, BLOCK_SIZE);
-	CMAC_Final(ctx, d, &mac_size);
+	memcpy(d, d0, BLOCK_SIZE);
 
 	for (int i = 0; i < num_additional_data; i++) {
 		const unsigned char *s = additional_data[i];
 		const size_t s_len = additional_data_sizes[i];
 		dbl(d, BLOCK_SIZE);
 		unsigned char s_mac[BLOCK_SIZE];
-		CMAC_Init(ctx, mac_key, mac_key_len, cipher, NULL);
+		CMAC_Init(ctx, NULL, 0, NULL, NULL);
 		CMAC_Update(ctx, s, s_len);
 		CMAC_Final(ctx, s_mac, &mac_size);
 		array_xor(d, s_mac, d, BLOCK_SIZE);
 	}
+}
 
-	size_t t_len = max(plaintext_len, BLOCK_SIZE);
-	unsigned char t[t_len];
+/* Second half of S2V: combines the plaintext with the result of s2v_cmac_ad */
+void s2v_cmac_final(CMAC_CTX *ctx, const unsigned char *prefix, const unsigned char *plaintext, const size_t plaintext_len, unsigned char *out) {
+	unsigned char d[BLOCK_SIZE];
+	size_t mac_size;
+	memcpy(d, prefix, BLOCK_SIZE);
+
+	CMAC_Init(ctx, NULL, 0, NULL, NULL);
 	if (plaintext_len >= BLOCK_SIZE) {
-		array_xorend(plaintext, plaintext_len, d, BLOCK_SIZE, t);
+		// xorend: only the last block differs from the plaintext, so the rest is fed to the cmac directly:
+		unsigned char last_block[BLOCK_SIZE];
+		array_xor(&plaintext[plaintext_len - BLOCK_SIZE], d, last_block, BLOCK_SIZE);
+		CMAC_Update(ctx, plaintext, plaintext_len - BLOCK_SIZE);
+		CMAC_Update(ctx, last_block, BLOCK_SIZE);
 	} else {
 		dbl(d, BLOCK_SIZE);
 		unsigned char padded_plaintext[BLOCK_SIZE];
 		pad(plaintext, plaintext_len, padded_plaintext, BLOCK_SIZE);
+		unsigned char t[BLOCK_SIZE];
 		array_xor(d, padded_plaintext, t, BLOCK_SIZE);
+		CMAC_Update(ctx, t, BLOCK_SIZE);
 	}
+	CMAC_Final(ctx, out, &mac_size);
+}
 
-	CMAC_Init(ctx, mac_key, mac_key_len, cipher, NULL);
-	CMAC_Update(ctx, t, t_len);
+/* S2V with a keyed CMAC context and the precomputed CMAC of the zero block */
+int s2v_cmac(CMAC_CTX *ctx, const unsigned char *d0, const unsigned char *plaintext, const size_t plaintext_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	unsigned char d[BLOCK_SIZE];
+	s2v_cmac_ad(ctx, d0, num_additional_data, additional_data, additional_data_sizes, d);
+	s2v_cmac_final(ctx, d, plaintext, plaintext_len, out);
+	return 0;
+}
+
+/* CMAC of the zero block, i.e. the initial value of D in S2V */
+void cmac_zero_block(CMAC_CTX *ctx, unsigned char *out) {
+	const unsigned char zeros[BLOCK_SIZE] = {0};
+	size_t mac_size;
+	CMAC_Update(ctx, zeros, BLOCK_SIZE);
 	CMAC_Final(ctx, out, &mac_size);
-	CMAC_CTX_cleanup(ctx);
-	CMAC_CTX_free(ctx);
+}
+
+/* SIV-CTR: clears the 31st and 63rd bit of the iv and xors the resulting keystream into the input */
+int siv_ctr(EVP_CIPHER_CTX *ctx, const unsigned char *iv, const unsigned char *in, const size_t in_len, unsigned char *out) {
+	// clear out the 31st and 63rd (rightmost) bit:
+	unsigned char ctr[16];
+	memcpy(ctr, iv, 16);
+	ctr[8] = (ctr[8] & 0x7F);
+	ctr[12] = (ctr[12] & 0x7F);
+
+	// the cleared 63rd bit guarantees that incrementing the whole 128 bit counter never carries into its upper half,
+	// so the keystream of the aes key schedule's bulk ctr mode is the same as incrementing only the lower 64 bit:
+	if (!EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, ctr)) {
+		return -1;
+	}
+	size_t offset = 0;
+	while (offset < in_len) {
+		const int32_t len = (int32_t)min(in_len - offset, INT32_MAX);
+		int32_t out_len;
+		if (!EVP_EncryptUpdate(ctx, &out[offset], &out_len, &in[offset], len)) {
+			return -1;
+		}
+		offset += out_len;
+	}
 	return 0;
 }
 
-int siv_enc(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+siv_ctx *siv_ctx_new(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len) {
 	assert(key_len == 16 || key_len == 24 || key_len == 32);
 
-	const EVP_CIPHER *cipher;
-	switch (key_len) {
-		case 16:
-			cipher = EVP_aes_128_ecb();
-			break;
-		case 24:
-			cipher = EVP_aes_192_ecb();
-			break;
-		case 32:
-			cipher = EVP_aes_256_ecb();
-			break;
-		default:
-			return -1;
+	const EVP_CIPHER *aes_cipher = ctr_cipher(key_len);
+	const EVP_CIPHER *mac_cipher = cbc_cipher(key_len);
+	if (!aes_cipher || !mac_cipher) {
+		return NULL;
 	}
 
-	unsigned char iv[16];
-	s2v(mac_key, key_len, in, in_len, num_additional_data, additional_data, additional_data_sizes, iv);
-	memcpy(out, iv, 16);
+	siv_ctx *ctx = calloc(1, sizeof(siv_ctx));
+	if (!ctx) {
+		return NULL;
+	}
+	ctx->ctr_ctx = EVP_CIPHER_CTX_new();
+	ctx->cmac_ctx = CMAC_CTX_new();
+	if (!ctx->ctr_ctx || !ctx->cmac_ctx) {
+		siv_ctx_free(ctx);
+		return NULL;
+	}
+
+	// aes key schedule for the ctr keystream, the counter is set per message:
+	if (!EVP_EncryptInit_ex(ctx->ctr_ctx, aes_cipher, NULL, aes_key, NULL)) {
+		siv_ctx_free(ctx);
+		return NULL;
+	}
 
-	size_t num_blocks = (in_len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	// cmac subkeys and the key independent part of s2v:
+	if (!CMAC_Init(ctx->cmac_ctx, mac_key, key_len, mac_cipher, NULL)) {
+		siv_ctx_free(ctx);
+		return NULL;
+	}
+	cmac_zero_block(ctx->cmac_ctx, ctx->d);
+	return ctx;
+}
 
-	// clear out the 31st and 63rd (rightmost) bit:
-	unsigned char ctr[16];
-	memcpy(ctr, iv, 16);
-	ctr[8] = (ctr[8] & 0x7F);
-	ctr[12] = (ctr[12] & 0x7F);
-	uint64_t init_ctr_val = big_endian_bytes_to_long(&ctr[8]);
+siv_ctx *siv_ctx_copy(const siv_ctx *ctx) {
+	siv_ctx *copy = calloc(1, sizeof(siv_ctx));
+	if (!copy) {
+		return NULL;
+	}
+	copy->ctr_ctx = EVP_CIPHER_CTX_new();
+	copy->cmac_ctx = CMAC_CTX_new();
+	if (!copy->ctr_ctx || !copy->cmac_ctx || !EVP_CIPHER_CTX_copy(copy->ctr_ctx, ctx->ctr_ctx) || !CMAC_CTX_copy(copy->cmac_ctx, ctx->cmac_ctx)) {
+		siv_ctx_free(copy);
+		return NULL;
+	}
+	memcpy(copy->d, ctx->d, BLOCK_SIZE);
+	return copy;
+}
 
-	size_t bytes_encrypted = 0;
+void siv_ctx_free(siv_ctx *ctx) {
+	if (!ctx) {
+		return;
+	}
+	if (ctx->ctr_ctx) {
+		EVP_CIPHER_CTX_free(ctx->ctr_ctx);
+	}
+	if (ctx->cmac_ctx) {
+		CMAC_CTX_free(ctx->cmac_ctx);
+	}
+	OPENSSL_cleanse(ctx, sizeof(siv_ctx));
+	free(ctx);
+}
 
-	EVP_CIPHER_CTX ctx;
-	EVP_CIPHER_CTX_init(&ctx);
-	EVP_CIPHER_CTX_set_padding(&ctx, 0);
-	EVP_EncryptInit_ex(&ctx, cipher, NULL, aes_key, NULL);
-	for (int i = 0; i < num_blocks; i++) {
-		uint64_t ctr_val = init_ctr_val + i;
-		long_to_big_endian_bytes(ctr_val, &ctr[8]);
-		int32_t out_len;
-		unsigned char x[16 + BLOCK_SIZE - 1] = {0};
-		EVP_EncryptUpdate(&ctx, x, &out_len, ctr, 16);
+int s2v(const unsigned char *mac_key, const size_t mac_key_len, const unsigned char *plaintext, const size_t plaintext_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	assert(mac_key_len == 16 || mac_key_len == 24 || mac_key_len == 32);
 
-		const size_t remaining_bytes = in_len - bytes_encrypted;
-		array_xor(&in[i * BLOCK_SIZE], x, &out[16 + i * BLOCK_SIZE], min(remaining_bytes, BLOCK_SIZE));
-		bytes_encrypted += out_len;
+	const EVP_CIPHER *cipher = cbc_cipher(mac_key_len);
+	if (!cipher) {
+		return -1;
 	}
-	EVP_CIPHER_CTX_cleanup(&ctx);
 
+	CMAC_CTX *ctx = CMAC_CTX_new();
+	CMAC_Init(ctx, mac_key, mac_key_len, cipher, NULL);
+
+	unsigned char d[BLOCK_SIZE];
+	cmac_zero_block(ctx, d);
+	s2v_cmac(ctx, d, plaintext, plaintext_len, num_additional_data, additional_data, additional_data_sizes, out);
+	CMAC_CTX_cleanup(ctx);
+	CMAC_CTX_free(ctx);
 	return 0;
 }
 
-int siv_dec(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
-	assert(key_len == 16 || key_len == 24 || key_len == 32);
-
-	const EVP_CIPHER *cipher;
-	switch (key_len) {
-		case 16:
-			cipher = EVP_aes_128_ecb();
-			break;
-		case 24:
-			cipher = EVP_aes_192_ecb();
-			break;
-		case 32:
-			cipher = EVP_aes_256_ecb();
-			break;
-		default:
-			return -1;
+int siv_enc(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	siv_ctx *ctx = siv_ctx_new(aes_key, mac_key, key_len);
+	if (!ctx) {
+		return -1;
 	}
+	int result = siv_enc_ctx(ctx, in, in_len, num_additional_data, additional_data, additional_data_sizes, out);
+	siv_ctx_free(ctx);
+	return result;
+}
 
-	unsigned char iv[16];
-	memcpy(iv, in, 16);
-	const unsigned char *ciphertext = &in[16];
-	const size_t ciphertext_len = in_len - 16;
+int siv_dec(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	siv_ctx *ctx = siv_ctx_new(aes_key, mac_key, key_len);
+	if (!ctx) {
+		return -1;
+	}
+	int result = siv_dec_ctx(ctx, in, in_len, num_additional_data, additional_data, additional_data_sizes, out);
+	siv_ctx_free(ctx);
+	return result;
+}
 
-	size_t num_blocks = (ciphertext_len + BLOCK_SIZE - 1) / BLOCK_SIZE;
-	assert(num_blocks > 0);
+int s2v_ctx(siv_ctx *ctx, const unsigned char *plaintext, const size_t plaintext_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	return s2v_cmac(ctx->cmac_ctx, ctx->d, plaintext, plaintext_len, num_additional_data, additional_data, additional_data_sizes, out);
+}
 
-	// clear out the 31st and 63rd (rightmost) bit:
-	unsigned char ctr[16];
-	memcpy(ctr, iv, 16);
-	ctr[8] = (ctr[8] & 0x7F);
-	ctr[12] = (ctr[12] & 0x7F);
-	uint64_t init_ctr_val = big_endian_bytes_to_long(&ctr[8]);
+int s2v_prefix_ctx(siv_ctx *ctx, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *prefix) {
+	s2v_cmac_ad(ctx->cmac_ctx, ctx->d, num_additional_data, additional_data, additional_data_sizes, prefix);
+	return 0;
+}
 
-	size_t bytes_decrypted = 0;
+int siv_enc_prefix_ctx(siv_ctx *ctx, const unsigned char *prefix, const unsigned char *in, const size_t in_len, unsigned char *out) {
+	unsigned char iv[16];
+	s2v_cmac_final(ctx->cmac_ctx, prefix, in, in_len, iv);
+	memcpy(out, iv, 16);
+	return siv_ctr(ctx->ctr_ctx, iv, in, in_len, &out[16]);
+}
 
-	EVP_CIPHER_CTX ctx;
-	EVP_CIPHER_CTX_init(&ctx);
-	EVP_CIPHER_CTX_set_padding(&ctx, 0);
-	EVP_EncryptInit_ex(&ctx, cipher, NULL, aes_key, NULL);
-	for (int i = 0; i < num_blocks; i++) {
-		uint64_t ctr_val = init_ctr_val + i;
-		long_to_big_endian_bytes(ctr_val, &ctr[8]);
-		int32_t out_len;
-		unsigned char x[16 + BLOCK_SIZE - 1] = {0};
-		EVP_EncryptUpdate(&ctx, x, &out_len, ctr, 16);
+int siv_dec_prefix_ctx(siv_ctx *ctx, const unsigned char *prefix, const unsigned char *in, const size_t in_len, unsigned char *out) {
+	assert(in_len > 16);
 
-		const size_t remaining_bytes = ciphertext_len - bytes_decrypted;
-		array_xor(&ciphertext[i * BLOCK_SIZE], x, &out[i * BLOCK_SIZE], min(remaining_bytes, BLOCK_SIZE));
-		bytes_decrypted += out_len;
+	unsigned char iv[16];
+	memcpy(iv, in, 16);
+	const unsigned char *ciphertext = &in[16];
+	const size_t ciphertext_len = in_len - 16;
+	if (siv_ctr(ctx->ctr_ctx, iv, ciphertext, ciphertext_len, out)) {
+		return -1;
 	}
-	EVP_CIPHER_CTX_cleanup(&ctx);
 
 	unsigned char control[16];
-	s2v(mac_key, key_len, out, ciphertext_len, num_additional_data, additional_data, additional_data_sizes, control);
+	s2v_cmac_final(ctx->cmac_ctx, prefix, out, ciphertext_len, control);
 
 	int equal = 1;
 	for (int i = 0; i < 16; i++) {
@@ -244,3 +315,15 @@ int siv_dec(const unsigned char *aes_key, const unsigned char *mac_key, const si
 		return -2;
 	}
 }
+
+int siv_enc_ctx(siv_ctx *ctx, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	unsigned char prefix[16];
+	s2v_prefix_ctx(ctx, num_additional_data, additional_data, additional_data_sizes, prefix);
+	return siv_enc_prefix_ctx(ctx, prefix, in, in_len, out);
+}
+
+int siv_dec_ctx(siv_ctx *ctx, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out) {
+	unsigned char prefix[16];
+	s2v_prefix_ctx(ctx, num_additional_data, additional_data, additional_data_sizes, prefix);
+	return siv_dec_prefix_ctx(ctx, prefix, in, in_len, out);
+}
@@ -9,8 +9,15 @@
 #ifndef __SETOCryptomatorCryptor__SETOAesSivCipherUtil__
 #define __SETOCryptomatorCryptor__SETOAesSivCipherUtil__
 
+#include <stddef.h>
 #include <stdint.h>
 
+/**
+ *  Precomputed SIV state for a pair of keys: the aes key schedule, the cmac subkeys and the cmac of the zero block.
+ *  A context must not be used by more than one thread at a time, use siv_ctx_copy to clone it for other threads.
+ */
+typedef struct siv_ctx siv_ctx;
+
 /**
  *  s2v
  *
@@ -61,4 +68,117 @@ int siv_enc(const unsigned char *aes_key, const unsigned char *mac_key, const si
  */
 int siv_dec(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out);
 
+/**
+ *  siv_ctx_new
+ *
+ *  @param aes_key               aes key
+ *  @param mac_key               mac key
+ *  @param key_len               aes/mac key length
+ *
+ *  @return new context to be released with siv_ctx_free, NULL on failure
+ */
+siv_ctx *siv_ctx_new(const unsigned char *aes_key, const unsigned char *mac_key, const size_t key_len);
+
+/**
+ *  siv_ctx_copy
+ *
+ *  @param ctx                   context to clone
+ *
+ *  @return new context with the same keys to be released with siv_ctx_free, NULL on failure
+ */
+siv_ctx *siv_ctx_copy(const siv_ctx *ctx);
+
+/**
+ *  siv_ctx_free
+ *
+ *  @param ctx                   context to release, its key material is wiped
+ */
+void siv_ctx_free(siv_ctx *ctx);
+
+/**
+ *  s2v_ctx
+ *
+ *  @param ctx                   precomputed context
+ *  @param plaintext             plaintext
+ *  @param plaintext_len         plantext length
+ *  @param num_additional_data   number of additional data
+ *  @param additional_data       additional data (two-dimensional)
+ *  @param additional_data_sizes additional data sizes
+ *  @param out                   buffer with at least 16 bytes
+ *
+ *  @return 0 on success
+ */
+int s2v_ctx(siv_ctx *ctx, const unsigned char *plaintext, const size_t plaintext_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out);
+
+/**
+ *  siv_enc_ctx
+ *
+ *  @param ctx                   precomputed context
+ *  @param in                    plaintext
+ *  @param in_len                plaintext length
+ *  @param num_additional_data   number of additional data
+ *  @param additional_data       additional data (two-dimensional)
+ *  @param additional_data_sizes additional data sizes
+ *  @param out                   buffer with at least in_len + 16 bytes
+ *
+ *  @return 0 on success
+ */
+int siv_enc_ctx(siv_ctx *ctx, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out);
+
+/**
+ *  siv_dec_ctx
+ *
+ *  @param ctx                   precomputed context
+ *  @param in                    ciphertext
+ *  @param in_len                ciphertext length
+ *  @param num_additional_data   number of additional data
+ *  @param additional_data       additional data (two-dimensional)
+ *  @param additional_data_sizes additional data sizes
+ *  @param out                   buffer with at least in_len - 16 bytes
+ *
+ *  @return 0 on success
+ */
+int siv_dec_ctx(siv_ctx *ctx, const unsigned char *in, const size_t in_len, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *out);
+
+/**
+ *  s2v_prefix_ctx
+ *
+ *  Computes the part of s2v that only depends on the additional data, so that it can be reused for many plaintexts with the same additional data.
+ *
+ *  @param ctx                   precomputed context
+ *  @param num_additional_data   number of additional data
+ *  @param additional_data       additional data (two-dimensional)
+ *  @param additional_data_sizes additional data sizes
+ *  @param prefix                buffer with at least 16 bytes
+ *
+ *  @return 0 on success
+ */
+int s2v_prefix_ctx(siv_ctx *ctx, const size_t num_additional_data, const unsigned char **additional_data, const size_t *additional_data_sizes, unsigned char *prefix);
+
+/**
+ *  siv_enc_prefix_ctx
+ *
+ *  @param ctx                   precomputed context
+ *  @param prefix                s2v prefix of the additional data, see s2v_prefix_ctx
+ *  @param in                    plaintext
+ *  @param in_len                plaintext length
+ *  @param out                   buffer with at least in_len + 16 bytes
+ *
+ *  @return 0 on success
+ */
+int siv_enc_prefix_ctx(siv_ctx *ctx, const unsigned char *prefix, const unsigned char *in, const size_t in_len, unsigned char *out);
+
+/**
+ *  siv_dec_prefix_ctx
+ *
+ *  @param ctx                   precomputed context
+ *  @param prefix                s2v prefix of the additional data, see s2v_prefix_ctx
+ *  @param in                    ciphertext
+ *  @param in_len                ciphertext length
+ *  @param out                   buffer with at least in_len - 16 bytes
+ *
+ *  @return 0 on success
+ */
+int siv_dec_prefix_ctx(siv_ctx *ctx, const unsigned char *prefix, const unsigned char *in, const size_t in_len, unsigned char *out);
+
 #endif /* defined(__SETOCryptomatorCryptor__SETOAesSivCipherUtil__) */
@@ -0,0 +1,327 @@
+//
+//  SETOBaseEncodingUtil.c
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#include "SETOBaseEncodingUtil.h"
+
+#include <stdint.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SETO_BASE_ENCODING_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SETO_BASE_ENCODING_SSE2 1
+#endif
+
+/* characters are translated in blocks of this size before their bits are packed */
+#define TRANSLATION_BLOCK_SIZE 256
+
+static const char base64url_alphabet[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static const char base32_alphabet[32] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+static inline int base64url_value(const unsigned char c) {
+	if (c >= 'A' && c <= 'Z') {
+		return c - 'A';
+	} else if (c >= 'a' && c <= 'z') {
+		return c - 'a' + 26;
+	} else if (c >= '0' && c <= '9') {
+		return c - '0' + 52;
+	} else if (c == '-') {
+		return 62;
+	} else if (c == '_') {
+		return 63;
+	} else {
+		return -1;
+	}
+}
+
+static inline int base32_value(const unsigned char c) {
+	if (c >= 'A' && c <= 'Z') {
+		return c - 'A';
+	} else if (c >= 'a' && c <= 'z') {
+		return c - 'a';
+	} else if (c >= '2' && c <= '7') {
+		return c - '2' + 26;
+	} else {
+		return -1;
+	}
+}
+
+/* translates 6 bit values to base64url characters in place, 16 at a time by adding a per-range offset */
+static void base64url_translate_values(unsigned char *buf, const size_t len) {
+	size_t i = 0;
+#if SETO_BASE_ENCODING_NEON
+	for (; i + 16 <= len; i += 16) {
+		const uint8x16_t v = vld1q_u8(&buf[i]);
+		uint8x16_t offset = vdupq_n_u8('A');
+		offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(v, vdupq_n_u8(25)), vdupq_n_u8('a' - 26 - 'A')));
+		offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(v, vdupq_n_u8(51)), vdupq_n_u8((uint8_t)('0' - 52 - 'a' + 26))));
+		offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(v, vdupq_n_u8(61)), vdupq_n_u8((uint8_t)('-' - 62 - '0' + 52))));
+		offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(v, vdupq_n_u8(62)), vdupq_n_u8('_' - 63 - '-' + 62)));
+		vst1q_u8(&buf[i], vaddq_u8(v, offset));
+	}
+#elif SETO_BASE_ENCODING_SSE2
+	for (; i + 16 <= len; i += 16) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)&buf[i]);
+		__m128i offset = _mm_set1_epi8('A');
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(25)), _mm_set1_epi8('a' - 26 - 'A')));
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(51)), _mm_set1_epi8('0' - 52 - 'a' + 26)));
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(61)), _mm_set1_epi8('-' - 62 - '0' + 52)));
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(62)), _mm_set1_epi8('_' - 63 - '-' + 62)));
+		_mm_storeu_si128((__m128i *)&buf[i], _mm_add_epi8(v, offset));
+	}
+#endif
+	for (; i < len; i++) {
+		buf[i] = base64url_alphabet[buf[i]];
+	}
+}
+
+/* translates base64url characters to 6 bit values, 16 at a time by range checks, returns -1 if any character is outside of the alphabet */
+static int base64url_translate_chars(const char *in, unsigned char *out, const size_t len) {
+	size_t i = 0;
+#if SETO_BASE_ENCODING_NEON
+	uint8x16_t invalid = vdupq_n_u8(0);
+	for (; i + 16 <= len; i += 16) {
+		const uint8x16_t c = vld1q_u8((const uint8_t *)&in[i]);
+		const uint8x16_t upper = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+		const uint8x16_t lower = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+		const uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')), vcleq_u8(c, vdupq_n_u8('9')));
+		const uint8x16_t dash = vceqq_u8(c, vdupq_n_u8('-'));
+		const uint8x16_t underscore = vceqq_u8(c, vdupq_n_u8('_'));
+		uint8x16_t offset = vandq_u8(upper, vdupq_n_u8((uint8_t)-'A'));
+		offset = vorrq_u8(offset, vandq_u8(lower, vdupq_n_u8((uint8_t)(26 - 'a'))));
+		offset = vorrq_u8(offset, vandq_u8(digit, vdupq_n_u8(52 - '0')));
+		offset = vorrq_u8(offset, vandq_u8(dash, vdupq_n_u8(62 - '-')));
+		offset = vorrq_u8(offset, vandq_u8(underscore, vdupq_n_u8((uint8_t)(63 - '_'))));
+		const uint8x16_t valid = vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, dash)), underscore);
+		invalid = vorrq_u8(invalid, vmvnq_u8(valid));
+		vst1q_u8(&out[i], vaddq_u8(c, offset));
+	}
+	const uint64x2_t invalid_lanes = vreinterpretq_u64_u8(invalid);
+	if (vgetq_lane_u64(invalid_lanes, 0) | vgetq_lane_u64(invalid_lanes, 1)) {
+		return -1;
+	}
+#elif SETO_BASE_ENCODING_SSE2
+	// signed comparison is fine, non-ascii characters are negative and therefore outside of every range:
+	int valid_mask = 0xFFFF;
+	for (; i + 16 <= len; i += 16) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)&in[i]);
+		const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+		const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+		const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+		const __m128i dash = _mm_cmpeq_epi8(c, _mm_set1_epi8('-'));
+		const __m128i underscore = _mm_cmpeq_epi8(c, _mm_set1_epi8('_'));
+		__m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+		offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+		offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+		offset = _mm_or_si128(offset, _mm_and_si128(dash, _mm_set1_epi8(62 - '-')));
+		offset = _mm_or_si128(offset, _mm_and_si128(underscore, _mm_set1_epi8(63 - '_')));
+		const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, dash)), underscore);
+		valid_mask &= _mm_movemask_epi8(valid);
+		_mm_storeu_si128((__m128i *)&out[i], _mm_add_epi8(c, offset));
+	}
+	if (valid_mask != 0xFFFF) {
+		return -1;
+	}
+#endif
+	for (; i < len; i++) {
+		const int value = base64url_value(in[i]);
+		if (value < 0) {
+			return -1;
+		}
+		out[i] = (unsigned char)value;
+	}
+	return 0;
+}
+
+/* translates 5 bit values to base32 characters in place, 16 at a time by adding a per-range offset */
+static void base32_translate_values(unsigned char *buf, const size_t len) {
+	size_t i = 0;
+#if SETO_BASE_ENCODING_NEON
+	for (; i + 16 <= len; i += 16) {
+		const uint8x16_t v = vld1q_u8(&buf[i]);
+		uint8x16_t offset = vdupq_n_u8('A');
+		offset = vaddq_u8(offset, vandq_u8(vcgtq_u8(v, vdupq_n_u8(25)), vdupq_n_u8((uint8_t)('2' - 26 - 'A'))));
+		vst1q_u8(&buf[i], vaddq_u8(v, offset));
+	}
+#elif SETO_BASE_ENCODING_SSE2
+	for (; i + 16 <= len; i += 16) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)&buf[i]);
+		__m128i offset = _mm_set1_epi8('A');
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(25)), _mm_set1_epi8('2' - 26 - 'A')));
+		_mm_storeu_si128((__m128i *)&buf[i], _mm_add_epi8(v, offset));
+	}
+#endif
+	for (; i < len; i++) {
+		buf[i] = base32_alphabet[buf[i]];
+	}
+}
+
+/* translates base32 characters to 5 bit values, 16 at a time by range checks, returns -1 if any character is outside of the alphabet */
+static int base32_translate_chars(const char *in, unsigned char *out, const size_t len) {
+	size_t i = 0;
+#if SETO_BASE_ENCODING_NEON
+	uint8x16_t invalid = vdupq_n_u8(0);
+	for (; i + 16 <= len; i += 16) {
+		const uint8x16_t c = vld1q_u8((const uint8_t *)&in[i]);
+		const uint8x16_t upper = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+		const uint8x16_t lower = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+		const uint8x16_t digit = vandq_u8(vcgeq_u8(c, vdupq_n_u8('2')), vcleq_u8(c, vdupq_n_u8('7')));
+		uint8x16_t offset = vandq_u8(upper, vdupq_n_u8((uint8_t)-'A'));
+		offset = vorrq_u8(offset, vandq_u8(lower, vdupq_n_u8((uint8_t)-'a')));
+		offset = vorrq_u8(offset, vandq_u8(digit, vdupq_n_u8((uint8_t)(26 - '2'))));
+		invalid = vorrq_u8(invalid, vmvnq_u8(vorrq_u8(vorrq_u8(upper, lower), digit)));
+		vst1q_u8(&out[i], vaddq_u8(c, offset));
+	}
+	const uint64x2_t invalid_lanes = vreinterpretq_u64_u8(invalid);
+	if (vgetq_lane_u64(invalid_lanes, 0) | vgetq_lane_u64(invalid_lanes, 1)) {
+		return -1;
+	}
+#elif SETO_BASE_ENCODING_SSE2
+	// signed comparison is fine, non-ascii characters are negative and therefore outside of every range:
+	int valid_mask = 0xFFFF;
+	for (; i + 16 <= len; i += 16) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)&in[i]);
+		const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+		const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+		const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('2' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('7' + 1)));
+		__m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+		offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi8(-'a')));
+		offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi8(26 - '2')));
+		valid_mask &= _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(upper, lower), digit));
+		_mm_storeu_si128((__m128i *)&out[i], _mm_add_epi8(c, offset));
+	}
+	if (valid_mask != 0xFFFF) {
+		return -1;
+	}
+#endif
+	for (; i < len; i++) {
+		const int value = base32_value(in[i]);
+		if (value < 0) {
+			return -1;
+		}
+		out[i] = (unsigned char)value;
+	}
+	return 0;
+}
+
+/* splits data into values of the given bit width, writes them to out and returns their number */
+static size_t unpack_values(const unsigned char *in, const size_t in_len, const int bits_per_value, unsigned char *out) {
+	const uint32_t mask = (1 << bits_per_value) - 1;
+	uint32_t buffer = 0;
+	int buffered_bits = 0;
+	size_t out_len = 0;
+	for (size_t i = 0; i < in_len; i++) {
+		buffer = (buffer << 8) | in[i];
+		buffered_bits += 8;
+		while (buffered_bits >= bits_per_value) {
+			buffered_bits -= bits_per_value;
+			out[out_len++] = (buffer >> buffered_bits) & mask;
+		}
+	}
+	if (buffered_bits > 0) {
+		out[out_len++] = (buffer << (bits_per_value - buffered_bits)) & mask;
+	}
+	return out_len;
+}
+
+/* decodes characters block by block, validating them during translation */
+static int decode(const char *in, const size_t in_len, const int bits_per_value, int (*translate_chars)(const char *, unsigned char *, const size_t), unsigned char *out, size_t *out_len) {
+	unsigned char values[TRANSLATION_BLOCK_SIZE];
+	uint32_t buffer = 0;
+	int buffered_bits = 0;
+	size_t decoded_len = 0;
+	for (size_t offset = 0; offset < in_len; offset += TRANSLATION_BLOCK_SIZE) {
+		const size_t block_len = in_len - offset < TRANSLATION_BLOCK_SIZE ? in_len - offset : TRANSLATION_BLOCK_SIZE;
+		if (translate_chars(&in[offset], values, block_len)) {
+			return -1;
+		}
+		for (size_t i = 0; i < block_len; i++) {
+			buffer = (buffer << bits_per_value) | values[i];
+			buffered_bits += bits_per_value;
+			if (buffered_bits >= 8) {
+				buffered_bits -= 8;
+				out[decoded_len++] = (unsigned char)(buffer >> buffered_bits);
+			}
+		}
+	}
+	*out_len = decoded_len;
+	return 0;
+}
+
+static size_t padding_length(const char *in, const size_t in_len, const size_t max_padding_len) {
+	size_t padding_len = 0;
+	while (padding_len < in_len && padding_len <= max_padding_len && in[in_len - 1 - padding_len] == '=') {
+		padding_len++;
+	}
+	return padding_len;
+}
+
+size_t seto_base64url_encoded_length(const size_t len) {
+	return (len + 2) / 3 * 4;
+}
+
+size_t seto_base64url_decoded_max_length(const size_t len) {
+	return len / 4 * 3;
+}
+
+size_t seto_base64url_encode(const unsigned char *in, const size_t in_len, char *out) {
+	// values are written to the output buffer and translated in place:
+	unsigned char *values = (unsigned char *)out;
+	const size_t values_len = unpack_values(in, in_len, 6, values);
+	base64url_translate_values(values, values_len);
+	const size_t out_len = seto_base64url_encoded_length(in_len);
+	for (size_t i = values_len; i < out_len; i++) {
+		out[i] = '=';
+	}
+	return out_len;
+}
+
+int seto_base64url_decode(const char *in, const size_t in_len, unsigned char *out, size_t *out_len) {
+	if (in_len % 4 != 0) {
+		return -1;
+	}
+	// at most 2 padding characters can occur in the last group:
+	const size_t padding_len = padding_length(in, in_len, 2);
+	if (padding_len > 2) {
+		return -1;
+	}
+	return decode(in, in_len - padding_len, 6, base64url_translate_chars, out, out_len);
+}
+
+size_t seto_base32_encoded_length(const size_t len) {
+	return (len + 4) / 5 * 8;
+}
+
+size_t seto_base32_decoded_max_length(const size_t len) {
+	return len / 8 * 5;
+}
+
+size_t seto_base32_encode(const unsigned char *in, const size_t in_len, char *out) {
+	// values are written to the output buffer and translated in place:
+	unsigned char *values = (unsigned char *)out;
+	const size_t values_len = unpack_values(in, in_len, 5, values);
+	base32_translate_values(values, values_len);
+	const size_t out_len = seto_base32_encoded_length(in_len);
+	for (size_t i = values_len; i < out_len; i++) {
+		out[i] = '=';
+	}
+	return out_len;
+}
+
+int seto_base32_decode(const char *in, const size_t in_len, unsigned char *out, size_t *out_len) {
+	if (in_len % 8 != 0) {
+		return -1;
+	}
+	// only 1, 3, 4 or 6 padding characters can occur in the last group:
+	const size_t padding_len = padding_length(in, in_len, 6);
+	if (padding_len == 2 || padding_len == 5 || padding_len > 6) {
+		return -1;
+	}
+	return decode(in, in_len - padding_len, 5, base32_translate_chars, out, out_len);
+}
@@ -0,0 +1,104 @@
+//
+//  SETOBaseEncodingUtil.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#ifndef __SETOCryptomatorCryptor__SETOBaseEncodingUtil__
+#define __SETOCryptomatorCryptor__SETOBaseEncodingUtil__
+
+#include <stddef.h>
+
+/**
+ *  seto_base64url_encoded_length
+ *
+ *  @param len                   data length
+ *
+ *  @return length of the padded base64url encoding
+ */
+size_t seto_base64url_encoded_length(const size_t len);
+
+/**
+ *  seto_base64url_decoded_max_length
+ *
+ *  @param len                   encoded length
+ *
+ *  @return upper bound of the decoded length
+ */
+size_t seto_base64url_decoded_max_length(const size_t len);
+
+/**
+ *  seto_base64url_encode
+ *
+ *  Encodes data using the url and filename safe alphabet of RFC 4648 including padding.
+ *
+ *  @param in                    data
+ *  @param in_len                data length
+ *  @param out                   buffer with at least seto_base64url_encoded_length(in_len) bytes, it is not null terminated
+ *
+ *  @return number of characters written
+ */
+size_t seto_base64url_encode(const unsigned char *in, const size_t in_len, char *out);
+
+/**
+ *  seto_base64url_decode
+ *
+ *  Validates alphabet, length and padding while decoding.
+ *
+ *  @param in                    padded base64url characters
+ *  @param in_len                number of characters
+ *  @param out                   buffer with at least seto_base64url_decoded_max_length(in_len) bytes
+ *  @param out_len               number of bytes written
+ *
+ *  @return 0 on success, -1 on invalid input
+ */
+int seto_base64url_decode(const char *in, const size_t in_len, unsigned char *out, size_t *out_len);
+
+/**
+ *  seto_base32_encoded_length
+ *
+ *  @param len                   data length
+ *
+ *  @return length of the padded base32 encoding
+ */
+size_t seto_base32_encoded_length(const size_t len);
+
+/**
+ *  seto_base32_decoded_max_length
+ *
+ *  @param len                   encoded length
+ *
+ *  @return upper bound of the decoded length
+ */
+size_t seto_base32_decoded_max_length(const size_t len);
+
+/**
+ *  seto_base32_encode
+ *
+ *  Encodes data using the base32 alphabet of RFC 4648 including padding.
+ *
+ *  @param in                    data
+ *  @param in_len                data length
+ *  @param out                   buffer with at least seto_base32_encoded_length(in_len) bytes, it is not null terminated
+ *
+ *  @return number of characters written
+ */
+size_t seto_base32_encode(const unsigned char *in, const size_t in_len, char *out);
+
+/**
+ *  seto_base32_decode
+ *
+ *  Validates alphabet, length and padding while decoding. Letters are case-insensitive.
+ *
+ *  @param in                    padded base32 characters
+ *  @param in_len                number of characters
+ *  @param out                   buffer with at least seto_base32_decoded_max_length(in_len) bytes
+ *  @param out_len               number of bytes written
+ *
+ *  @return 0 on success, -1 on invalid input
+ */
+int seto_base32_decode(const char *in, const size_t in_len, unsigned char *out, size_t *out_len);
+
+#endif /* defined(__SETOCryptomatorCryptor__SETOBaseEncodingUtil__) */
@@ -0,0 +1,28 @@
+//
+//  SETOFileHandle.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  @c SETOFileHandle is a thin wrapper around a file descriptor for positional I/O via @c pread and @c pwrite. Since no file offset is shared, multiple threads can read and write different offsets of the same file at the same time.
+ */
+@interface SETOFileHandle : NSObject
+
++ (instancetype)fileHandleForReadingAtPath:(NSString *)path error:(NSError **)error;
++ (instancetype)fileHandleForWritingAtPath:(NSString *)path error:(NSError **)error; // creates or truncates file
++ (instancetype)fileHandleForUpdatingAtPath:(NSString *)path error:(NSError **)error;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) uint64_t fileSize;
+
+- (NSInteger)readBytes:(void *)buffer length:(NSUInteger)length atOffset:(uint64_t)offset; // returns less than length only at end of file, -1 on error
+- (BOOL)writeBytes:(const void *)buffer length:(NSUInteger)length atOffset:(uint64_t)offset;
+- (BOOL)truncateAtOffset:(uint64_t)offset;
+- (void)closeFile;
+
+@end
@@ -0,0 +1,113 @@
+//
+//  SETOFileHandle.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileHandle.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+@interface SETOFileHandle ()
+@property (nonatomic, assign) int fileDescriptor;
+@end
+
+@implementation SETOFileHandle
+
+#pragma mark - Initialization
+
++ (instancetype)fileHandleForReadingAtPath:(NSString *)path error:(NSError **)error {
+	return [self fileHandleAtPath:path flags:O_RDONLY error:error];
+}
+
++ (instancetype)fileHandleForWritingAtPath:(NSString *)path error:(NSError **)error {
+	return [self fileHandleAtPath:path flags:O_WRONLY | O_CREAT | O_TRUNC error:error];
+}
+
++ (instancetype)fileHandleForUpdatingAtPath:(NSString *)path error:(NSError **)error {
+	return [self fileHandleAtPath:path flags:O_RDWR error:error];
+}
+
++ (instancetype)fileHandleAtPath:(NSString *)path flags:(int)flags error:(NSError **)error {
+	NSParameterAssert(path);
+	int fileDescriptor;
+	do {
+		fileDescriptor = open(path.fileSystemRepresentation, flags, 0644);
+	} while (fileDescriptor < 0 && errno == EINTR);
+	if (fileDescriptor < 0) {
+		if (error) {
+			*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey: path}];
+		}
+		return nil;
+	}
+	return [[self alloc] initWithFileDescriptor:fileDescriptor];
+}
+
+- (instancetype)initWithFileDescriptor:(int)fileDescriptor {
+	if (self = [super init]) {
+		self.fileDescriptor = fileDescriptor;
+	}
+	return self;
+}
+
+- (void)dealloc {
+	[self closeFile];
+}
+
+#pragma mark - Positional I/O
+
+- (uint64_t)fileSize {
+	struct stat fileStat;
+	if (fstat(self.fileDescriptor, &fileStat) != 0) {
+		return 0;
+	}
+	return fileStat.st_size;
+}
+
+- (NSInteger)readBytes:(void *)buffer length:(NSUInteger)length atOffset:(uint64_t)offset {
+	NSUInteger bytesRead = 0;
+	while (bytesRead < length) {
+		ssize_t result = pread(self.fileDescriptor, (unsigned char *)buffer + bytesRead, length - bytesRead, (off_t)(offset + bytesRead));
+		if (result < 0 && errno == EINTR) {
+			continue;
+		} else if (result < 0) {
+			return -1;
+		} else if (result == 0) {
+			break; // end of file
+		}
+		bytesRead += result;
+	}
+	return bytesRead;
+}
+
+- (BOOL)writeBytes:(const void *)buffer length:(NSUInteger)length atOffset:(uint64_t)offset {
+	NSUInteger bytesWritten = 0;
+	while (bytesWritten < length) {
+		ssize_t result = pwrite(self.fileDescriptor, (const unsigned char *)buffer + bytesWritten, length - bytesWritten, (off_t)(offset + bytesWritten));
+		if (result < 0 && errno == EINTR) {
+			continue;
+		} else if (result <= 0) {
+			return NO;
+		}
+		bytesWritten += result;
+	}
+	return YES;
+}
+
+- (BOOL)truncateAtOffset:(uint64_t)offset {
+	return ftruncate(self.fileDescriptor, (off_t)offset) == 0;
+}
+
+- (void)closeFile {
+	if (self.fileDescriptor >= 0) {
+		close(self.fileDescriptor);
+		self.fileDescriptor = -1;
+	}
+}
+
+@end
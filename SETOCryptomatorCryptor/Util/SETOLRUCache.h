@@ -0,0 +1,29 @@
+//
+//  SETOLRUCache.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  @c SETOLRUCache is a bounded, thread-safe key-value cache that evicts the least recently used entry once its capacity is exceeded. Lookups and insertions take constant time.
+ */
+@interface SETOLRUCache : NSObject
+
+@property (nonatomic, assign) NSUInteger capacity; // reducing the capacity evicts least recently used entries, 0 disables caching
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (id)objectForKey:(id<NSCopying>)key; // counts as hit or miss
+- (void)setObject:(id)object forKey:(id<NSCopying>)key;
+- (void)removeAllObjects; // hit and miss counts are kept
+- (void)removeObjectsPassingTest:(BOOL (^)(id key, id object))predicate; // predicate is called without holding the lock, entries changed meanwhile are kept
+
+@end
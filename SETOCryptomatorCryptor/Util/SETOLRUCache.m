@@ -0,0 +1,196 @@
+//
+//  SETOLRUCache.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOLRUCache.h"
+
+#import <pthread.h>
+
+@interface SETOLRUCacheEntry : NSObject
+@property (nonatomic, strong) id<NSCopying> key;
+@property (nonatomic, strong) id object;
+@property (nonatomic, unsafe_unretained) SETOLRUCacheEntry *previous;
+@property (nonatomic, unsafe_unretained) SETOLRUCacheEntry *next;
+@end
+
+@implementation SETOLRUCacheEntry
+@end
+
+@implementation SETOLRUCache {
+	pthread_mutex_t _mutex;
+	NSMutableDictionary *_entries; // owns all entries, the list links are unretained
+	SETOLRUCacheEntry *_head; // most recently used
+	SETOLRUCacheEntry *_tail; // least recently used
+	NSUInteger _capacity;
+	NSUInteger _hitCount;
+	NSUInteger _missCount;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+	if (self = [super init]) {
+		pthread_mutex_init(&_mutex, NULL);
+		_entries = [NSMutableDictionary dictionary];
+		_capacity = capacity;
+	}
+	return self;
+}
+
+- (void)dealloc {
+	pthread_mutex_destroy(&_mutex);
+}
+
+#pragma mark - Accessors
+
+- (NSUInteger)capacity {
+	pthread_mutex_lock(&_mutex);
+	NSUInteger capacity = _capacity;
+	pthread_mutex_unlock(&_mutex);
+	return capacity;
+}
+
+- (void)setCapacity:(NSUInteger)capacity {
+	pthread_mutex_lock(&_mutex);
+	_capacity = capacity;
+	[self evictEntriesExceedingCapacity];
+	pthread_mutex_unlock(&_mutex);
+}
+
+- (NSUInteger)count {
+	pthread_mutex_lock(&_mutex);
+	NSUInteger count = _entries.count;
+	pthread_mutex_unlock(&_mutex);
+	return count;
+}
+
+- (NSUInteger)hitCount {
+	pthread_mutex_lock(&_mutex);
+	NSUInteger hitCount = _hitCount;
+	pthread_mutex_unlock(&_mutex);
+	return hitCount;
+}
+
+- (NSUInteger)missCount {
+	pthread_mutex_lock(&_mutex);
+	NSUInteger missCount = _missCount;
+	pthread_mutex_unlock(&_mutex);
+	return missCount;
+}
+
+#pragma mark - Caching
+
+- (id)objectForKey:(id<NSCopying>)key {
+	NSParameterAssert(key);
+	pthread_mutex_lock(&_mutex);
+	SETOLRUCacheEntry *entry = _entries[key];
+	id object = entry.object;
+	if (entry) {
+		_hitCount++;
+		[self unlinkEntry:entry];
+		[self insertEntryAtHead:entry];
+	} else {
+		_missCount++;
+	}
+	pthread_mutex_unlock(&_mutex);
+	return object;
+}
+
+- (void)setObject:(id)object forKey:(id<NSCopying>)key {
+	NSParameterAssert(object);
+	NSParameterAssert(key);
+	pthread_mutex_lock(&_mutex);
+	if (_capacity > 0) {
+		SETOLRUCacheEntry *entry = _entries[key];
+		if (entry) {
+			[self unlinkEntry:entry];
+		} else {
+			entry = [[SETOLRUCacheEntry alloc] init];
+			entry.key = [key copyWithZone:nil];
+			_entries[entry.key] = entry;
+		}
+		entry.object = object;
+		[self insertEntryAtHead:entry];
+		[self evictEntriesExceedingCapacity];
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+- (void)removeAllObjects {
+	pthread_mutex_lock(&_mutex);
+	_head = nil;
+	_tail = nil;
+	[_entries removeAllObjects];
+	pthread_mutex_unlock(&_mutex);
+}
+
+- (void)removeObjectsPassingTest:(BOOL (^)(id key, id object))predicate {
+	NSParameterAssert(predicate);
+	// the predicate is evaluated without holding the mutex, so it may call back into the cache:
+	pthread_mutex_lock(&_mutex);
+	NSMutableArray *entries = [NSMutableArray arrayWithCapacity:_entries.count];
+	NSMutableArray *objects = [NSMutableArray arrayWithCapacity:_entries.count];
+	for (SETOLRUCacheEntry *entry = _head; entry; entry = entry.next) {
+		[entries addObject:entry];
+		[objects addObject:entry.object];
+	}
+	pthread_mutex_unlock(&_mutex);
+	NSIndexSet *indexes = [entries indexesOfObjectsPassingTest:^BOOL(SETOLRUCacheEntry *entry, NSUInteger idx, BOOL *stop) {
+		return predicate(entry.key, objects[idx]);
+	}];
+	pthread_mutex_lock(&_mutex);
+	[indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+		// skip entries that have been evicted or replaced in the meantime:
+		SETOLRUCacheEntry *entry = entries[idx];
+		if (self->_entries[entry.key] == entry && entry.object == objects[idx]) {
+			[self unlinkEntry:entry];
+			[self->_entries removeObjectForKey:entry.key];
+		}
+	}];
+	pthread_mutex_unlock(&_mutex);
+}
+
+#pragma mark - List Management
+
+// must be called while holding the mutex:
+- (void)unlinkEntry:(SETOLRUCacheEntry *)entry {
+	if (entry.previous) {
+		entry.previous.next = entry.next;
+	} else {
+		_head = entry.next;
+	}
+	if (entry.next) {
+		entry.next.previous = entry.previous;
+	} else {
+		_tail = entry.previous;
+	}
+	entry.previous = nil;
+	entry.next = nil;
+}
+
+// must be called while holding the mutex:
+- (void)insertEntryAtHead:(SETOLRUCacheEntry *)entry {
+	entry.next = _head;
+	if (_head) {
+		_head.previous = entry;
+	}
+	_head = entry;
+	if (!_tail) {
+		_tail = entry;
+	}
+}
+
+// must be called while holding the mutex:
+- (void)evictEntriesExceedingCapacity {
+	while (_entries.count > _capacity && _tail) {
+		SETOLRUCacheEntry *entry = _tail;
+		[self unlinkEntry:entry];
+		[_entries removeObjectForKey:entry.key];
+	}
+}
+
+@end
@@ -0,0 +1,30 @@
+//
+//  SETOMasterKeyContext.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "SETOAesSivCipherUtil.h"
+
+#import <CommonCrypto/CommonHMAC.h>
+
+@class SETOMasterKey;
+
+/**
+ *  @c SETOMasterKeyContext holds the key setup derived from a master key, so that it is done once instead of for every file header, chunk or filename: the HMAC-SHA256 state after absorbing the padded MAC key, the AES-CTR key schedule of the AES master key and the AES-SIV state. The context is immutable after initialization. Each method works on a cheap clone of the precomputed state, so it can be used from any number of threads at the same time. AES-SIV clones are pooled, so that filename encryption does not allocate in the steady state.
+ */
+@interface SETOMasterKeyContext : NSObject
+
+- (instancetype)initWithMasterKey:(SETOMasterKey *)masterKey NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)getHmacContext:(CCHmacContext *)hmacContext; // HMAC-SHA256 keyed with mac master key, ready for CCHmacUpdate
+- (BOOL)cryptHeaderPayload:(const unsigned char *)input length:(int)length iv:(const unsigned char *)iv output:(unsigned char *)output; // AES-CTR with aes master key
+- (siv_ctx *)acquireSivContext; // AES-SIV with aes and mac master key, return with relinquishSivContext:
+- (void)relinquishSivContext:(siv_ctx *)sivContext;
+
+@end
@@ -0,0 +1,112 @@
+//
+//  SETOMasterKeyContext.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOMasterKeyContext.h"
+#import "SETOMasterKey.h"
+
+#import <openssl/evp.h>
+#import <pthread.h>
+
+#define SETO_SIV_CONTEXT_POOL_CAPACITY 16
+
+@implementation SETOMasterKeyContext {
+	CCHmacContext _hmacContext;
+	EVP_CIPHER_CTX *_headerCipherContext;
+	siv_ctx *_sivContext;
+	siv_ctx *_sivContextPool[SETO_SIV_CONTEXT_POOL_CAPACITY];
+	NSUInteger _sivContextPoolCount;
+	pthread_mutex_t _sivContextPoolMutex;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithMasterKey:(SETOMasterKey *)masterKey {
+	NSParameterAssert(masterKey);
+	if (self = [super init]) {
+		pthread_mutex_init(&_sivContextPoolMutex, NULL);
+
+		// hmac inner and outer state:
+		CCHmacInit(&_hmacContext, kCCHmacAlgSHA256, masterKey.macMasterKey.bytes, masterKey.macMasterKey.length);
+
+		// aes key schedule for header payloads:
+		_headerCipherContext = EVP_CIPHER_CTX_new();
+		if (!_headerCipherContext) {
+			return nil;
+		}
+		EVP_CIPHER_CTX_set_padding(_headerCipherContext, 0);
+		if (!EVP_EncryptInit_ex(_headerCipherContext, EVP_aes_256_ctr(), NULL, masterKey.aesMasterKey.bytes, NULL)) {
+			return nil;
+		}
+
+		// cmac subkeys and aes key schedule for filenames:
+		_sivContext = siv_ctx_new(masterKey.aesMasterKey.bytes, masterKey.macMasterKey.bytes, masterKey.aesMasterKey.length);
+		if (!_sivContext) {
+			return nil;
+		}
+	}
+	return self;
+}
+
+- (void)dealloc {
+	memset_s(&_hmacContext, sizeof(_hmacContext), 0, sizeof(_hmacContext));
+	if (_headerCipherContext) {
+		EVP_CIPHER_CTX_free(_headerCipherContext);
+	}
+	siv_ctx_free(_sivContext);
+	for (NSUInteger i = 0; i < _sivContextPoolCount; i++) {
+		siv_ctx_free(_sivContextPool[i]);
+	}
+	pthread_mutex_destroy(&_sivContextPoolMutex);
+}
+
+#pragma mark - Clones
+
+- (void)getHmacContext:(CCHmacContext *)hmacContext {
+	NSParameterAssert(hmacContext);
+	*hmacContext = _hmacContext;
+}
+
+- (BOOL)cryptHeaderPayload:(const unsigned char *)input length:(int)length iv:(const unsigned char *)iv output:(unsigned char *)output {
+	NSParameterAssert(input);
+	NSParameterAssert(iv);
+	NSParameterAssert(output);
+	EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+	if (!ctx || !EVP_CIPHER_CTX_copy(ctx, _headerCipherContext) || !EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, iv)) {
+		EVP_CIPHER_CTX_free(ctx);
+		return NO;
+	}
+	int bytesProcessed = 0;
+	int status = EVP_EncryptUpdate(ctx, output, &bytesProcessed, input, length);
+	EVP_CIPHER_CTX_free(ctx);
+	return status != 0 && bytesProcessed == length;
+}
+
+- (siv_ctx *)acquireSivContext {
+	siv_ctx *sivContext = NULL;
+	pthread_mutex_lock(&_sivContextPoolMutex);
+	if (_sivContextPoolCount > 0) {
+		sivContext = _sivContextPool[--_sivContextPoolCount];
+	}
+	pthread_mutex_unlock(&_sivContextPoolMutex);
+	return sivContext ?: siv_ctx_copy(_sivContext);
+}
+
+- (void)relinquishSivContext:(siv_ctx *)sivContext {
+	if (!sivContext) {
+		return;
+	}
+	pthread_mutex_lock(&_sivContextPoolMutex);
+	if (_sivContextPoolCount < SETO_SIV_CONTEXT_POOL_CAPACITY) {
+		_sivContextPool[_sivContextPoolCount++] = sivContext;
+		sivContext = NULL;
+	}
+	pthread_mutex_unlock(&_sivContextPoolMutex);
+	siv_ctx_free(sivContext);
+}
+
+@end
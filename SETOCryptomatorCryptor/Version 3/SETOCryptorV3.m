@@ -7,14 +7,20 @@
 //
 
 #import "SETOCryptorV3.h"
+#import "SETOCryptorV3_Private.h"
 #import "SETOMasterKey.h"
 
+#import "NSData+SETOBase32Encoding.h"
 #import "SETOAesSivCipherUtil.h"
+#import "SETOBaseEncodingUtil.h"
 #import "SETOCryptoSupport.h"
+#import "SETOFileContentDecryptorV3.h"
+#import "SETOFileHandle.h"
+#import "SETOLRUCache.h"
+#import "SETOMasterKeyContext.h"
 
 #import <CommonCrypto/CommonDigest.h>
 #import <CommonCrypto/CommonHMAC.h>
-#import <Base32/MF_Base32Additions.h>
 #import <openssl/evp.h>
 
 size_t const kSETOCryptorV3BlockSize = 16;
@@ -22,10 +28,12 @@ int const kSETOCryptorV3NonceLength = 16;
 int const kSETOCryptorV3HeaderLength = 88;
 int const kSETOCryptorV3HeaderPayloadLength = 40;
 int const kSETOCryptorV3ChunkPayloadLength = 32 * 1024;
-NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2-7=]{8}$";
+NSUInteger const kSETOCryptorV3MinFilenamesPerWorker = 64;
 
 @interface SETOCryptorV3 ()
 @property (nonatomic, strong) SETOMasterKey *masterKey;
+@property (nonatomic, strong) SETOMasterKeyContext *masterKeyContext;
+@property (nonatomic, strong) SETOLRUCache *directoryIdCache;
 @end
 
 @implementation SETOCryptorV3
@@ -34,69 +42,198 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 
 - (NSString *)encryptDirectoryId:(NSString *)directoryId {
 	NSParameterAssert(directoryId);
+	NSString *cachedEncryptedDirectoryId = [self.directoryIdCache objectForKey:directoryId];
+	if (cachedEncryptedDirectoryId) {
+		return cachedEncryptedDirectoryId;
+	}
 	NSData *cleartext = [directoryId dataUsingEncoding:NSUTF8StringEncoding];
 	unsigned char *ciphertext = malloc(cleartext.length + 16);
-	if (siv_enc(self.masterKey.aesMasterKey.bytes, self.masterKey.macMasterKey.bytes, self.masterKey.aesMasterKey.length, cleartext.bytes, cleartext.length, 0, NULL, NULL, ciphertext)) {
+	siv_ctx *sivContext = [self.masterKeyContext acquireSivContext];
+	if (!sivContext || siv_enc_ctx(sivContext, cleartext.bytes, cleartext.length, 0, NULL, NULL, ciphertext)) {
+		[self.masterKeyContext relinquishSivContext:sivContext];
 		free(ciphertext);
 		return nil;
 	}
+	[self.masterKeyContext relinquishSivContext:sivContext];
 	unsigned char hashed[CC_SHA1_DIGEST_LENGTH];
 	CC_SHA1(ciphertext, (CC_LONG)cleartext.length + 16, hashed);
 	free(ciphertext);
 	NSData *ciphertextData = [NSData dataWithBytes:hashed length:sizeof(hashed)];
-	return [ciphertextData base32String];
+	NSString *encryptedDirectoryId = [ciphertextData seto_base32EncodedString];
+	[self.directoryIdCache setObject:encryptedDirectoryId forKey:directoryId];
+	return encryptedDirectoryId;
 }
 
 - (NSString *)encryptFilename:(NSString *)filename insideDirectoryWithId:(NSString *)directoryId {
 	NSParameterAssert(filename);
-	NSData *cleartext = [filename dataUsingEncoding:NSUTF8StringEncoding];
-	unsigned char *ciphertext = malloc(cleartext.length + 16);
-	NSData *directoryIdData = [directoryId dataUsingEncoding:NSUTF8StringEncoding];
-	const unsigned char *additionalData[1] = {directoryIdData.bytes};
-	const size_t additionalDataSizes[1] = {directoryIdData.length};
-	if (siv_enc(self.masterKey.aesMasterKey.bytes, self.masterKey.macMasterKey.bytes, self.masterKey.aesMasterKey.length, cleartext.bytes, cleartext.length, 1, additionalData, additionalDataSizes, ciphertext)) {
-		free(ciphertext);
+	NSUInteger filenameLength = [filename lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	NSUInteger directoryIdLength = [directoryId lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	NSMutableData *buffer = [NSMutableData dataWithLength:[self encryptedFilenameLengthForFilenameLength:filenameLength]];
+	NSInteger encryptedFilenameLength = [self encryptFilenameUTF8String:filename.UTF8String length:filenameLength insideDirectoryWithIdUTF8String:directoryId.UTF8String length:directoryIdLength buffer:buffer.mutableBytes maxLength:buffer.length];
+	if (encryptedFilenameLength < 0) {
 		return nil;
 	}
-	NSData *ciphertextData = [NSData dataWithBytesNoCopy:ciphertext length:cleartext.length + 16];
-	return [self encodeFilename:ciphertextData];
+	return [[NSString alloc] initWithBytes:buffer.bytes length:encryptedFilenameLength encoding:NSASCIIStringEncoding];
 }
 
 - (NSString *)decryptFilename:(NSString *)filename insideDirectoryWithId:(NSString *)directoryId {
 	NSParameterAssert(filename);
-	if (![self isValidEncryptedFilename:filename]) {
+	NSUInteger filenameLength = [filename lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	NSUInteger directoryIdLength = [directoryId lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	NSMutableData *buffer = [NSMutableData dataWithLength:filenameLength];
+	NSInteger decryptedFilenameLength = [self decryptFilenameUTF8String:filename.UTF8String length:filenameLength insideDirectoryWithIdUTF8String:directoryId.UTF8String length:directoryIdLength buffer:buffer.mutableBytes maxLength:buffer.length];
+	if (decryptedFilenameLength < 0) {
 		return nil;
 	}
-	NSData *ciphertext = [self decodeFilename:filename];
-	if (!ciphertext) {
+	return [[NSString alloc] initWithBytes:buffer.bytes length:decryptedFilenameLength encoding:NSUTF8StringEncoding];
+}
+
+- (NSDictionary *)decryptFilenames:(NSArray *)filenames insideDirectoryWithId:(NSString *)directoryId {
+	NSParameterAssert(filenames);
+	siv_ctx *sivContext = [self.masterKeyContext acquireSivContext];
+	unsigned char s2vPrefix[16];
+	if (!sivContext || ![self getS2VPrefix:s2vPrefix forDirectoryIdUTF8String:directoryId.UTF8String length:[directoryId lengthOfBytesUsingEncoding:NSUTF8StringEncoding] sivContext:sivContext]) {
+		[self.masterKeyContext relinquishSivContext:sivContext];
 		return nil;
 	}
-	unsigned char *cleartext = malloc(ciphertext.length - 16);
-	NSData *directoryIdData = [directoryId dataUsingEncoding:NSUTF8StringEncoding];
-	const unsigned char *additionalData[1] = {directoryIdData.bytes};
-	const size_t additionalDataSizes[1] = {directoryIdData.length};
-	if (siv_dec(self.masterKey.aesMasterKey.bytes, self.masterKey.macMasterKey.bytes, self.masterKey.aesMasterKey.length, ciphertext.bytes, ciphertext.length, 1, additionalData, additionalDataSizes, cleartext)) {
-		free(cleartext);
-		return nil;
+
+	// the directory ID only needs to be processed once, filenames are distributed among workers with a clone of the precomputed context each:
+	NSUInteger filenameCount = filenames.count;
+	NSUInteger workerCount = MAX(MIN([NSProcessInfo processInfo].activeProcessorCount, filenameCount / kSETOCryptorV3MinFilenamesPerWorker), 1);
+	NSMutableDictionary *cleartexts = [NSMutableDictionary dictionaryWithCapacity:filenameCount];
+	const unsigned char *sharedS2VPrefix = s2vPrefix;
+	__block BOOL failed = NO;
+	dispatch_apply(workerCount, dispatch_get_global_queue(qos_class_self(), 0), ^(size_t worker) {
+		siv_ctx *workerSivContext = siv_ctx_copy(sivContext);
+		if (!workerSivContext) {
+			// a missing slice would look like invalid ciphertexts, so the whole batch fails:
+			@synchronized(cleartexts) {
+				failed = YES;
+			}
+			return;
+		}
+		NSUInteger start = filenameCount * worker / workerCount;
+		NSUInteger end = filenameCount * (worker + 1) / workerCount;
+		NSMutableDictionary *workerCleartexts = [NSMutableDictionary dictionaryWithCapacity:end - start];
+		NSMutableData *buffer = [NSMutableData data];
+		for (NSUInteger i = start; i < end; i++) {
+			@autoreleasepool {
+				NSString *filename = filenames[i];
+				NSUInteger filenameLength = [filename lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+				if (buffer.length < filenameLength) {
+					buffer.length = filenameLength;
+				}
+				NSInteger cleartextLength = [self decryptFilenameUTF8String:filename.UTF8String length:filenameLength s2vPrefix:sharedS2VPrefix sivContext:workerSivContext buffer:buffer.mutableBytes];
+				NSString *cleartext = cleartextLength < 0 ? nil : [[NSString alloc] initWithBytes:buffer.bytes length:cleartextLength encoding:NSUTF8StringEncoding];
+				if (cleartext) {
+					workerCleartexts[filename] = cleartext;
+				}
+			}
+		}
+		siv_ctx_free(workerSivContext);
+		@synchronized(cleartexts) {
+			[cleartexts addEntriesFromDictionary:workerCleartexts];
+		}
+	});
+	[self.masterKeyContext relinquishSivContext:sivContext];
+	return failed ? nil : cleartexts;
+}
+
+- (NSInteger)encryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength {
+	NSParameterAssert(filename || filenameLength == 0);
+	NSParameterAssert(buffer || maxLength == 0);
+	NSUInteger ciphertextLength = filenameLength + 16;
+	NSUInteger encodedLength = [self encryptedFilenameLengthForFilenameLength:filenameLength];
+	if (encodedLength > maxLength) {
+		return -1;
+	}
+
+	// ciphertext is placed at the end of the buffer and encoded in place, the encoder never overtakes its input:
+	unsigned char *ciphertext = (unsigned char *)&buffer[encodedLength - ciphertextLength];
+	const unsigned char *additionalData[1] = {(const unsigned char *)directoryId};
+	const size_t additionalDataSizes[1] = {directoryIdLength};
+	siv_ctx *sivContext = [self.masterKeyContext acquireSivContext];
+	if (!sivContext || siv_enc_ctx(sivContext, (const unsigned char *)filename, filenameLength, 1, additionalData, additionalDataSizes, ciphertext)) {
+		[self.masterKeyContext relinquishSivContext:sivContext];
+		return -1;
+	}
+	[self.masterKeyContext relinquishSivContext:sivContext];
+	return [self encodeFilename:ciphertext length:ciphertextLength buffer:buffer];
+}
+
+- (NSInteger)decryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength insideDirectoryWithIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength buffer:(char *)buffer maxLength:(NSUInteger)maxLength {
+	NSParameterAssert(filename || filenameLength == 0);
+	NSParameterAssert(buffer || maxLength == 0);
+	if ([self decodedMaxLengthOfFilenameLength:filenameLength] > maxLength) {
+		return -1;
+	}
+	siv_ctx *sivContext = [self.masterKeyContext acquireSivContext];
+	unsigned char s2vPrefix[16];
+	NSInteger cleartextLength = -1;
+	if (sivContext && [self getS2VPrefix:s2vPrefix forDirectoryIdUTF8String:directoryId length:directoryIdLength sivContext:sivContext]) {
+		cleartextLength = [self decryptFilenameUTF8String:filename length:filenameLength s2vPrefix:s2vPrefix sivContext:sivContext buffer:buffer];
+	}
+	[self.masterKeyContext relinquishSivContext:sivContext];
+	return cleartextLength;
+}
+
+- (BOOL)getS2VPrefix:(unsigned char *)s2vPrefix forDirectoryIdUTF8String:(const char *)directoryId length:(NSUInteger)directoryIdLength sivContext:(siv_ctx *)sivContext {
+	const unsigned char *additionalData[1] = {(const unsigned char *)directoryId};
+	const size_t additionalDataSizes[1] = {directoryIdLength};
+	return s2v_prefix_ctx(sivContext, 1, additionalData, additionalDataSizes, s2vPrefix) == 0;
+}
+
+- (NSInteger)decryptFilenameUTF8String:(const char *)filename length:(NSUInteger)filenameLength s2vPrefix:(const unsigned char *)s2vPrefix sivContext:(siv_ctx *)sivContext buffer:(char *)buffer {
+	// invalid encodings are rejected while decoding, siv needs more than 16 bytes:
+	unsigned char *ciphertext = (unsigned char *)buffer;
+	NSUInteger ciphertextLength = 0;
+	if (![self decodeFilename:filename length:filenameLength buffer:ciphertext decodedLength:&ciphertextLength] || ciphertextLength <= 16) {
+		return -1;
+	}
+
+	// decrypt in place behind the synthetic iv and move cleartext to the beginning of the buffer, unauthenticated cleartext is wiped:
+	NSUInteger cleartextLength = ciphertextLength - 16;
+	if (siv_dec_prefix_ctx(sivContext, s2vPrefix, ciphertext, ciphertextLength, &ciphertext[16])) {
+		memset(buffer, 0, ciphertextLength);
+		return -1;
 	}
-	NSData *cleartextData = [NSData dataWithBytesNoCopy:cleartext length:ciphertext.length - 16];
-	return [[NSString alloc] initWithData:cleartextData encoding:NSUTF8StringEncoding];
+	memmove(buffer, &ciphertext[16], cleartextLength);
+	return cleartextLength;
+}
+
+#pragma mark - Encrypted Filename Length
+
+- (NSUInteger)encryptedFilenameLengthForFilenameLength:(NSUInteger)filenameLength {
+	// siv adds a 16 bytes synthetic iv, the encoding expands it by a fixed ratio:
+	return [self encodedLengthOfFilenameLength:filenameLength + 16];
+}
+
+- (NSUInteger)maxFilenameLengthForEncryptedFilenameLength:(NSUInteger)encryptedFilenameLength {
+	NSUInteger maxCiphertextLength = [self decodedMaxLengthOfFilenameLength:encryptedFilenameLength];
+	return maxCiphertextLength > 16 ? maxCiphertextLength - 16 : 0;
 }
 
 #pragma mark - Path Encoding and Decoding
 
-- (NSString *)encodeFilename:(NSData *)filename {
-	return [filename base32String];
+- (NSUInteger)encodedLengthOfFilenameLength:(NSUInteger)length {
+	return seto_base32_encoded_length(length);
 }
 
-- (NSData *)decodeFilename:(NSString *)filename {
-	return [NSData dataWithBase32String:filename];
+- (NSUInteger)decodedMaxLengthOfFilenameLength:(NSUInteger)length {
+	return seto_base32_decoded_max_length(length);
 }
 
-- (BOOL)isValidEncryptedFilename:(NSString *)filename {
-	NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:kSETOCryptorV3CiphertextFilenamePattern options:NSRegularExpressionCaseInsensitive error:NULL];
-	NSUInteger numberOfMatches = [regex numberOfMatchesInString:filename options:0 range:NSMakeRange(0, filename.length)];
-	return numberOfMatches > 0;
+- (NSUInteger)encodeFilename:(const unsigned char *)filename length:(NSUInteger)length buffer:(char *)buffer {
+	return seto_base32_encode(filename, length, buffer);
+}
+
+- (BOOL)decodeFilename:(const char *)filename length:(NSUInteger)length buffer:(unsigned char *)buffer decodedLength:(NSUInteger *)decodedLength {
+	size_t outputLength = 0;
+	if (seto_base32_decode(filename, length, buffer, &outputLength)) {
+		return NO;
+	}
+	*decodedLength = outputLength;
+	return YES;
 }
 
 #pragma mark - File Content Encryption and Decryption
@@ -105,14 +242,14 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 	NSParameterAssert(path);
 	NSParameterAssert(callback);
 
-	// read ciphertext file size:
-	NSError *fileAttributesError;
-	NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:&fileAttributesError];
-	if (fileAttributesError) {
-		callback(fileAttributesError);
+	// open ciphertext input and read its file size:
+	NSError *error;
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:path error:&error];
+	if (!input) {
+		callback(error);
 		return;
 	}
-	uint64_t totalFileSize = [fileAttributes fileSize];
+	uint64_t totalFileSize = input.fileSize;
 
 	// init progress:
 	uint64_t bytesProcessed = 0;
@@ -120,68 +257,33 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 		progressCallback(0.0);
 	}
 
-	// open ciphertext input:
-	NSInputStream *input = [NSInputStream inputStreamWithFileAtPath:path];
-	[input scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[input open];
-
 	// read file header:
 	unsigned char header[kSETOCryptorV3HeaderLength];
-	int inputLength = (int)[input read:header maxLength:sizeof(header)];
+	NSInteger inputLength = [input readBytes:header length:sizeof(header) atOffset:0];
 	if (inputLength != sizeof(header)) {
-		[input close];
+		[input closeFile];
 		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
 		return;
 	}
 	bytesProcessed += inputLength;
 
-	// iv is at the beginning of file header:
-	unsigned char *iv = &header[0];
-
-	// calculate mac over file header:
-	unsigned char calculatedHeaderMac[CC_SHA256_DIGEST_LENGTH];
-	CCHmacContext headerHmacContext;
-	CCHmacInit(&headerHmacContext, kCCHmacAlgSHA256, self.masterKey.macMasterKey.bytes, self.masterKey.macMasterKey.length);
-	CCHmacUpdate(&headerHmacContext, header, 56); // 56 bytes: 16 bytes iv + 8 bytes file size + 32 bytes file key (without mac)
-	CCHmacFinal(&headerHmacContext, calculatedHeaderMac);
-
-	// calculate macs over file chunks:
+	// authenticate file header and file chunks, all macs are calculated before failing:
+	BOOL headerMacsEqual = [self isAuthenticFileHeader:header];
 	BOOL chunkMacsEqual = YES;
 	uint64_t chunkNumber = 0;
 	int ciphertextChunkLength = kSETOCryptorV3NonceLength + kSETOCryptorV3ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH; // nonce + payload + mac
 	NSMutableData *ciphertextChunk = [NSMutableData dataWithLength:ciphertextChunkLength];
-	while (input.hasBytesAvailable) {
+	while (bytesProcessed < totalFileSize) {
 		// read chunk:
-		unsigned char *ciphertextChunkBuffer = ciphertextChunk.mutableBytes;
-		int inputLength = (int)[input read:ciphertextChunkBuffer maxLength:ciphertextChunkLength];
-		if (inputLength == 0) {
-			continue;
-		} else if (inputLength < kSETOCryptorV3NonceLength + CC_SHA256_DIGEST_LENGTH) {
-			[input close];
+		int inputLength = (int)[input readBytes:ciphertextChunk.mutableBytes length:ciphertextChunkLength atOffset:bytesProcessed];
+		if (inputLength < kSETOCryptorV3NonceLength + CC_SHA256_DIGEST_LENGTH) {
+			[input closeFile];
 			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorAuthenticationFailedError userInfo:nil]);
 			return;
 		}
 
-		// init authentication:
-		unsigned char *expectedMac = &ciphertextChunkBuffer[inputLength - CC_SHA256_DIGEST_LENGTH];
-		unsigned char calculatedMac[CC_SHA256_DIGEST_LENGTH];
-		unsigned char chunkNumberBytes[sizeof(uint64_t)] = {0};
-		unsigned char *nonce = &ciphertextChunkBuffer[0];
-		unsigned char *payload = &ciphertextChunkBuffer[kSETOCryptorV3NonceLength];
-		int payloadLength = inputLength - kSETOCryptorV3NonceLength - CC_SHA256_DIGEST_LENGTH;
-		long_to_big_endian_bytes(chunkNumber, chunkNumberBytes);
-
-		// calculate chunk mac:
-		CCHmacContext chunkHmacContext;
-		CCHmacInit(&chunkHmacContext, kCCHmacAlgSHA256, self.masterKey.macMasterKey.bytes, self.masterKey.macMasterKey.length);
-		CCHmacUpdate(&chunkHmacContext, iv, 16);
-		CCHmacUpdate(&chunkHmacContext, chunkNumberBytes, sizeof(chunkNumberBytes));
-		CCHmacUpdate(&chunkHmacContext, nonce, kSETOCryptorV3NonceLength);
-		CCHmacUpdate(&chunkHmacContext, payload, payloadLength);
-		CCHmacFinal(&chunkHmacContext, calculatedMac);
-
-		// constant time comparison of chunk mac:
-		chunkMacsEqual &= compare_bytes(calculatedMac, expectedMac, CC_SHA256_DIGEST_LENGTH);
+		// authenticate chunk:
+		chunkMacsEqual &= [self isAuthenticChunk:ciphertextChunk.bytes length:inputLength chunkNumber:chunkNumber headerIv:header];
 
 		// progress:
 		bytesProcessed += inputLength;
@@ -191,12 +293,8 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 		}
 	}
 
-	// constant time comparison of header mac:
-	unsigned char *expectedHeaderMac = &header[56];
-	BOOL headerMacsEqual = compare_bytes(calculatedHeaderMac, expectedHeaderMac, CC_SHA256_DIGEST_LENGTH);
-
 	// done:
-	[input close];
+	[input closeFile];
 	if (progressCallback) {
 		progressCallback(1.0);
 	}
@@ -208,14 +306,14 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 	NSParameterAssert(outPath);
 	NSParameterAssert(callback);
 
-	// read cleartext file size:
-	NSError *filesAttributesError;
-	NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:inPath error:&filesAttributesError];
-	if (filesAttributesError) {
-		callback(filesAttributesError);
+	// open cleartext input and read its file size:
+	NSError *error;
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:inPath error:&error];
+	if (!input) {
+		callback(error);
 		return;
 	}
-	uint64_t fileSize = [fileAttributes fileSize];
+	uint64_t fileSize = input.fileSize;
 
 	// determine length of random padding:
 	uint32_t maxPaddingLength = (uint32_t)MIN(MAX(fileSize / 10, 4096), 16 * 1024 * 1024);
@@ -233,6 +331,7 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 
 	// create random iv:
 	if (SecRandomCopyBytes(kSecRandomDefault, 16, header) == -1) {
+		[input closeFile];
 		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 		return;
 	}
@@ -242,6 +341,7 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 	// create random file key:
 	unsigned char fileKey[32];
 	if (SecRandomCopyBytes(kSecRandomDefault, 32, fileKey) == -1) {
+		[input closeFile];
 		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 		return;
 	}
@@ -250,55 +350,50 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 	unsigned char cleartextHeaderPayload[kSETOCryptorV3HeaderPayloadLength];
 	long_to_big_endian_bytes(fileSize, cleartextHeaderPayload);
 	memcpy(&cleartextHeaderPayload[8], fileKey, sizeof(fileKey));
-	{
-		const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
-		EVP_CIPHER_CTX ctx;
-		EVP_CIPHER_CTX_init(&ctx);
-		EVP_CIPHER_CTX_set_padding(&ctx, 0);
-		EVP_EncryptInit_ex(&ctx, ctrCipher, NULL, self.masterKey.aesMasterKey.bytes, iv);
-		int bytesEncrypted = 0;
-		int encryptStatus = EVP_EncryptUpdate(&ctx, ciphertextHeaderPayload, &bytesEncrypted, cleartextHeaderPayload, kSETOCryptorV3HeaderPayloadLength);
-		if (encryptStatus == 0 || bytesEncrypted != kSETOCryptorV3HeaderPayloadLength) {
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
-			return;
-		}
-		EVP_CIPHER_CTX_cleanup(&ctx);
+	if (![self.masterKeyContext cryptHeaderPayload:cleartextHeaderPayload length:kSETOCryptorV3HeaderPayloadLength iv:iv output:ciphertextHeaderPayload]) {
+		[input closeFile];
+		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
+		return;
 	}
 
 	// calculate mac over file header:
 	CCHmacContext headerHmacContext;
-	CCHmacInit(&headerHmacContext, kCCHmacAlgSHA256, self.masterKey.macMasterKey.bytes, self.masterKey.macMasterKey.length);
+	[self.masterKeyContext getHmacContext:&headerHmacContext];
 	CCHmacUpdate(&headerHmacContext, header, 56);
 	CCHmacFinal(&headerHmacContext, &header[56]);
 
-	// open cleartext input stream:
-	NSInputStream *input = [NSInputStream inputStreamWithFileAtPath:inPath];
-	[input scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[input open];
-
-	// open ciphertext output stream and write header:
-	NSOutputStream *output = [NSOutputStream outputStreamToFileAtPath:outPath append:NO];
-	[output scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[output open];
-	[output write:header maxLength:sizeof(header)];
+	// open ciphertext output and write header:
+	SETOFileHandle *output = [SETOFileHandle fileHandleForWritingAtPath:outPath error:&error];
+	if (!output) {
+		[input closeFile];
+		callback(error);
+		return;
+	}
+	if (![output writeBytes:header length:sizeof(header) atOffset:0]) {
+		[input closeFile];
+		[output closeFile];
+		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
+		return;
+	}
+	uint64_t outputOffset = sizeof(header);
 
-	// encrypt then mac content + padding:
+	// encrypt then mac content + padding (key schedule of file key is set up once, only the nonce changes per chunk):
 	const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
 	EVP_CIPHER_CTX ctx;
 	EVP_CIPHER_CTX_init(&ctx);
 	EVP_CIPHER_CTX_set_padding(&ctx, 0);
+	EVP_EncryptInit_ex(&ctx, ctrCipher, NULL, fileKey, NULL);
 	uint64_t chunkNumber = 0;
-	while (input.hasBytesAvailable && bytesProcessed < bytesTotal) {
-		// read chunk:
+	while (bytesProcessed < bytesTotal) {
+		// read chunk, empty once only padding remains:
 		int cleartextChunkLength = kSETOCryptorV3ChunkPayloadLength;
 		unsigned char cleartextChunk[cleartextChunkLength];
-		int inputLength = (int)[input read:cleartextChunk maxLength:cleartextChunkLength];
-		if (inputLength == 0) {
-			continue;
-		} else if (inputLength < 0) {
-			[input close];
-			[output close];
+		uint64_t cleartextOffset = chunkNumber * kSETOCryptorV3ChunkPayloadLength;
+		int cleartextLength = (cleartextOffset < fileSize) ? (int)MIN(fileSize - cleartextOffset, kSETOCryptorV3ChunkPayloadLength) : 0;
+		int inputLength = (int)[input readBytes:cleartextChunk length:cleartextLength atOffset:cleartextOffset];
+		if (inputLength != cleartextLength) {
+			[input closeFile];
+			[output closeFile];
 			EVP_CIPHER_CTX_cleanup(&ctx);
 			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 			return;
@@ -316,18 +411,21 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 		unsigned char ciphertextChunk[ciphertextChunkLength + kSETOCryptorV3BlockSize];
 		unsigned char *nonce = &ciphertextChunk[0];
 		if (SecRandomCopyBytes(kSecRandomDefault, 16, nonce) == -1) {
+			[input closeFile];
+			[output closeFile];
+			EVP_CIPHER_CTX_cleanup(&ctx);
 			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 			return;
 		}
-		EVP_EncryptInit_ex(&ctx, ctrCipher, NULL, fileKey, nonce);
+		EVP_EncryptInit_ex(&ctx, NULL, NULL, NULL, nonce);
 
 		// encrypt chunk:
 		int bytesEncrypted;
 		unsigned char *payload = &ciphertextChunk[16];
 		int encryptStatus = EVP_EncryptUpdate(&ctx, payload, &bytesEncrypted, cleartextChunk, inputLength);
 		if (encryptStatus == 0 || bytesEncrypted != payloadLength) {
-			[input close];
-			[output close];
+			[input closeFile];
+			[output closeFile];
 			EVP_CIPHER_CTX_cleanup(&ctx);
 			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 			return;
@@ -338,7 +436,7 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 		unsigned char chunkNumberBytes[sizeof(uint64_t)] = {0};
 		long_to_big_endian_bytes(chunkNumber, chunkNumberBytes);
 		CCHmacContext chunkHmacContext;
-		CCHmacInit(&chunkHmacContext, kCCHmacAlgSHA256, self.masterKey.macMasterKey.bytes, self.masterKey.macMasterKey.length);
+		[self.masterKeyContext getHmacContext:&chunkHmacContext];
 		CCHmacUpdate(&chunkHmacContext, iv, 16);
 		CCHmacUpdate(&chunkHmacContext, chunkNumberBytes, sizeof(chunkNumberBytes));
 		CCHmacUpdate(&chunkHmacContext, nonce, 16);
@@ -346,14 +444,14 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 		CCHmacFinal(&chunkHmacContext, chunkMac);
 
 		// write ciphertext chunk:
-		int bytesWritten = (int)[output write:ciphertextChunk maxLength:ciphertextChunkLength];
-		if (bytesWritten != ciphertextChunkLength) {
-			[input close];
-			[output close];
+		if (![output writeBytes:ciphertextChunk length:ciphertextChunkLength atOffset:outputOffset]) {
+			[input closeFile];
+			[output closeFile];
 			EVP_CIPHER_CTX_cleanup(&ctx);
 			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 			return;
 		}
+		outputOffset += ciphertextChunkLength;
 
 		// progress:
 		bytesProcessed += payloadLength;
@@ -365,8 +463,8 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 	EVP_CIPHER_CTX_cleanup(&ctx);
 
 	// done:
-	[input close];
-	[output close];
+	[input closeFile];
+	[output closeFile];
 	if (progressCallback) {
 		progressCallback(1.0);
 	}
@@ -378,128 +476,225 @@ NSString *const kSETOCryptorV3CiphertextFilenamePattern = @"^([A-Z2-7]{8})*[A-Z2
 	NSParameterAssert(outPath);
 	NSParameterAssert(callback);
 
-	// open ciphertext input stream:
-	NSInputStream *input = [NSInputStream inputStreamWithFileAtPath:inPath];
-	[input scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[input open];
+	// open ciphertext input:
+	NSError *error;
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:inPath error:&error];
+	if (!input) {
+		callback(error);
+		return;
+	}
 
 	// read file header:
 	unsigned char header[kSETOCryptorV3HeaderLength];
-	int inputLength = (int)[input read:header maxLength:sizeof(header)];
+	NSInteger inputLength = [input readBytes:header length:sizeof(header) atOffset:0];
 	if (inputLength != sizeof(header)) {
-		[input close];
+		[input closeFile];
 		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
 		return;
 	}
 
-	// iv is at the beginning of file header:
-	unsigned char *iv = &header[0];
-	unsigned char *ciphertextHeaderPayload = &header[16];
-
-	// decrypt header data:
-	unsigned char cleartextHeaderPayload[kSETOCryptorV3HeaderPayloadLength + kSETOCryptorV3BlockSize];
-	{
-		const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
-		EVP_CIPHER_CTX ctx;
-		EVP_CIPHER_CTX_init(&ctx);
-		EVP_CIPHER_CTX_set_padding(&ctx, 0);
-		EVP_DecryptInit_ex(&ctx, ctrCipher, NULL, self.masterKey.aesMasterKey.bytes, iv);
-		int bytesDecrypted = 0;
-		int decryptStatus = EVP_DecryptUpdate(&ctx, cleartextHeaderPayload, &bytesDecrypted, ciphertextHeaderPayload, kSETOCryptorV3HeaderPayloadLength);
-		if (decryptStatus == 0 || bytesDecrypted != kSETOCryptorV3HeaderPayloadLength) {
-			[input close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
-			return;
-		}
-		EVP_CIPHER_CTX_cleanup(&ctx);
+	// decrypt file header:
+	uint64_t fileSize = 0;
+	unsigned char fileKey[32];
+	if (![self decryptFileHeader:header fileSize:&fileSize fileKey:fileKey]) {
+		[input closeFile];
+		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
+		return;
 	}
 
-	// extract file size and file key:
-	uint64_t fileSize = big_endian_bytes_to_long(&cleartextHeaderPayload[0]);
-	unsigned char *fileKey = &cleartextHeaderPayload[8];
-
 	// initialize bytes processed:
 	uint64_t bytesProcessed = 0;
 	if (progressCallback) {
 		progressCallback(0.0);
 	}
 
-	// open cleartext output stream:
-	NSOutputStream *output = [NSOutputStream outputStreamToFileAtPath:outPath append:NO];
-	[output scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[output open];
+	// open cleartext output:
+	SETOFileHandle *output = [SETOFileHandle fileHandleForWritingAtPath:outPath error:&error];
+	if (!output) {
+		[input closeFile];
+		memset_s(fileKey, sizeof(fileKey), 0, sizeof(fileKey));
+		callback(error);
+		return;
+	}
+	uint64_t inputOffset = sizeof(header);
 
-	// decrypt content (ignoring chunk macs, assuming it's authentic):
-	const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
+	// decrypt content (ignoring chunk macs, assuming it's authentic), the file key is expanded only once:
 	EVP_CIPHER_CTX ctx;
-	EVP_CIPHER_CTX_init(&ctx);
-	EVP_CIPHER_CTX_set_padding(&ctx, 0);
-	while (input.hasBytesAvailable && bytesProcessed < fileSize) {
-		// read chunk:
-		int ciphertextChunkLength = kSETOCryptorV3NonceLength + kSETOCryptorV3ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
-		unsigned char ciphertextChunk[ciphertextChunkLength];
-		int inputLength = (int)[input read:ciphertextChunk maxLength:ciphertextChunkLength];
-		if (inputLength == 0) {
-			continue;
-		} else if (inputLength < kSETOCryptorV3NonceLength + CC_SHA256_DIGEST_LENGTH) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
-			return;
+	BOOL success = [self initCipherContext:&ctx withFileKey:fileKey];
+	memset_s(fileKey, sizeof(fileKey), 0, sizeof(fileKey));
+	int ciphertextChunkLength = kSETOCryptorV3NonceLength + kSETOCryptorV3ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
+	NSMutableData *ciphertextChunk = [NSMutableData dataWithLength:ciphertextChunkLength];
+	NSMutableData *cleartextChunk = [NSMutableData dataWithLength:kSETOCryptorV3ChunkPayloadLength];
+	while (success && bytesProcessed < fileSize) {
+		// read and decrypt chunk:
+		int inputLength = (int)[input readBytes:ciphertextChunk.mutableBytes length:ciphertextChunkLength atOffset:inputOffset];
+		int cleartextChunkLength = 0;
+		if (![self decryptChunk:ciphertextChunk.bytes length:inputLength cipherContext:&ctx cleartextChunk:cleartextChunk.mutableBytes cleartextChunkLength:&cleartextChunkLength]) {
+			success = NO;
+			break;
 		}
 
-		// init decryption:
-		unsigned char *nonce = &ciphertextChunk[0];
-		unsigned char *payload = &ciphertextChunk[kSETOCryptorV3NonceLength];
-		EVP_DecryptInit_ex(&ctx, ctrCipher, NULL, fileKey, nonce);
-
-		// calculate payload length:
-		int payloadLength = inputLength - kSETOCryptorV3NonceLength - CC_SHA256_DIGEST_LENGTH;
+		// write cleartext chunk, ignoring padding if necessary:
 		uint64_t remainingFileSize = fileSize - bytesProcessed;
-		int remainingPayloadLength = payloadLength < remainingFileSize ? payloadLength : (int)remainingFileSize; // ignore padding if necessary
-
-		// decrypt chunk:
-		int cleartextChunkLength = payloadLength + kSETOCryptorV3BlockSize;
-		unsigned char cleartextChunk[cleartextChunkLength];
-		int outputLength = 0;
-		int decryptStatus = EVP_DecryptUpdate(&ctx, cleartextChunk, &outputLength, payload, remainingPayloadLength);
-		if (decryptStatus == 0) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
-			return;
-		}
-
-		// write cleartext chunk:
-		int bytesWritten = (int)[output write:cleartextChunk maxLength:outputLength];
-		if (bytesWritten != outputLength) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
-			return;
+		int outputLength = cleartextChunkLength < remainingFileSize ? cleartextChunkLength : (int)remainingFileSize;
+		if (![output writeBytes:cleartextChunk.bytes length:outputLength atOffset:bytesProcessed]) {
+			success = NO;
+			break;
 		}
+		inputOffset += inputLength;
 
 		// progress:
-		bytesProcessed += payloadLength;
+		bytesProcessed += cleartextChunkLength;
 		if (progressCallback) {
 			progressCallback((CGFloat)bytesProcessed / fileSize);
 		}
 	}
 	EVP_CIPHER_CTX_cleanup(&ctx);
+	memset_s(cleartextChunk.mutableBytes, cleartextChunk.length, 0, cleartextChunk.length);
 
 	// done:
-	[input close];
-	[output close];
+	[input closeFile];
+	[output closeFile];
+	if (!success) {
+		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
+		return;
+	}
 	if (progressCallback) {
 		progressCallback(1.0);
 	}
 	callback(nil);
 }
 
+#pragma mark - Random Access File Content Encryption and Decryption
+
+- (NSData *)decryptRange:(NSRange)range ofFileAtPath:(NSString *)path error:(NSError **)error {
+	NSLog(@"-[SETOCryptor decryptRange:ofFileAtPath:error:] not defined for cryptor version 3 and 4");
+	if (error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil];
+	}
+	return nil;
+}
+
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)path atOffset:(NSUInteger)offset error:(NSError **)error {
+	NSLog(@"-[SETOCryptor writeData:toFileAtPath:atOffset:error:] not defined for cryptor version 3 and 4");
+	if (error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+	}
+	return NO;
+}
+
+- (BOOL)appendData:(NSData *)data toFileAtPath:(NSString *)path error:(NSError **)error {
+	NSLog(@"-[SETOCryptor appendData:toFileAtPath:error:] not defined for cryptor version 3 and 4");
+	if (error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+	}
+	return NO;
+}
+
+- (BOOL)truncateFileAtPath:(NSString *)path toCleartextSize:(NSUInteger)size error:(NSError **)error {
+	NSLog(@"-[SETOCryptor truncateFileAtPath:toCleartextSize:error:] not defined for cryptor version 3 and 4");
+	if (error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+	}
+	return NO;
+}
+
+#pragma mark - Streaming File Content Encryption and Decryption
+
+- (SETOFileContentEncryptor *)fileContentEncryptorWithError:(NSError **)error {
+	NSLog(@"-[SETOCryptor fileContentEncryptorWithError:] not defined for cryptor version 3 and 4");
+	if (error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+	}
+	return nil;
+}
+
+- (SETOFileContentDecryptor *)fileContentDecryptorWithSource:(SETOCryptorReadCallback)source error:(NSError **)error {
+	NSParameterAssert(source);
+	return [[SETOFileContentDecryptorV3 alloc] initWithCryptor:self source:source];
+}
+
+#pragma mark - File Header
+
+- (BOOL)decryptFileHeader:(const unsigned char *)header fileSize:(uint64_t *)fileSize fileKey:(unsigned char *)fileKey {
+	// iv is at the beginning of file header:
+	const unsigned char *iv = &header[0];
+	const unsigned char *ciphertextHeaderPayload = &header[16];
+
+	// decrypt header data:
+	unsigned char cleartextHeaderPayload[kSETOCryptorV3HeaderPayloadLength];
+	if (![self.masterKeyContext cryptHeaderPayload:ciphertextHeaderPayload length:kSETOCryptorV3HeaderPayloadLength iv:iv output:cleartextHeaderPayload]) {
+		return NO;
+	}
+
+	// extract file size and file key:
+	*fileSize = big_endian_bytes_to_long(&cleartextHeaderPayload[0]);
+	memcpy(fileKey, &cleartextHeaderPayload[8], 32);
+	memset_s(cleartextHeaderPayload, sizeof(cleartextHeaderPayload), 0, sizeof(cleartextHeaderPayload));
+	return YES;
+}
+
+- (BOOL)isAuthenticFileHeader:(const unsigned char *)header {
+	// calculate mac over file header:
+	unsigned char calculatedHeaderMac[CC_SHA256_DIGEST_LENGTH];
+	CCHmacContext headerHmacContext;
+	[self.masterKeyContext getHmacContext:&headerHmacContext];
+	CCHmacUpdate(&headerHmacContext, header, 56); // 56 bytes: 16 bytes iv + 8 bytes file size + 32 bytes file key (without mac)
+	CCHmacFinal(&headerHmacContext, calculatedHeaderMac);
+
+	// constant time comparison of header mac:
+	unsigned char *expectedHeaderMac = (unsigned char *)&header[56];
+	return compare_bytes(calculatedHeaderMac, expectedHeaderMac, CC_SHA256_DIGEST_LENGTH);
+}
+
+#pragma mark - File Content Chunks
+
+- (BOOL)initCipherContext:(EVP_CIPHER_CTX *)ctx withFileKey:(const unsigned char *)fileKey {
+	EVP_CIPHER_CTX_init(ctx);
+	EVP_CIPHER_CTX_set_padding(ctx, 0);
+	return EVP_DecryptInit_ex(ctx, EVP_aes_256_ctr(), NULL, fileKey, NULL) != 0;
+}
+
+- (BOOL)decryptChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength cipherContext:(EVP_CIPHER_CTX *)ctx cleartextChunk:(unsigned char *)cleartextChunk cleartextChunkLength:(int *)cleartextChunkLength {
+	if (ciphertextChunkLength < kSETOCryptorV3NonceLength + CC_SHA256_DIGEST_LENGTH) {
+		return NO;
+	}
+
+	// calculate payload length:
+	const unsigned char *nonce = &ciphertextChunk[0];
+	const unsigned char *payload = &ciphertextChunk[kSETOCryptorV3NonceLength];
+	int payloadLength = ciphertextChunkLength - kSETOCryptorV3NonceLength - CC_SHA256_DIGEST_LENGTH;
+
+	// decrypt chunk, only the nonce is set per chunk:
+	if (!EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, nonce)) {
+		return NO;
+	}
+	int decryptStatus = EVP_DecryptUpdate(ctx, cleartextChunk, cleartextChunkLength, payload, payloadLength);
+	return decryptStatus != 0 && *cleartextChunkLength == payloadLength;
+}
+
+- (BOOL)isAuthenticChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength chunkNumber:(uint64_t)chunkNumber headerIv:(const unsigned char *)headerIv {
+	if (ciphertextChunkLength < kSETOCryptorV3NonceLength + CC_SHA256_DIGEST_LENGTH) {
+		return NO;
+	}
+
+	// calculate chunk mac:
+	int payloadLength = ciphertextChunkLength - kSETOCryptorV3NonceLength - CC_SHA256_DIGEST_LENGTH;
+	unsigned char calculatedMac[CC_SHA256_DIGEST_LENGTH];
+	unsigned char chunkNumberBytes[sizeof(uint64_t)] = {0};
+	long_to_big_endian_bytes(chunkNumber, chunkNumberBytes);
+	CCHmacContext chunkHmacContext;
+	[self.masterKeyContext getHmacContext:&chunkHmacContext];
+	CCHmacUpdate(&chunkHmacContext, headerIv, 16);
+	CCHmacUpdate(&chunkHmacContext, chunkNumberBytes, sizeof(chunkNumberBytes));
+	CCHmacUpdate(&chunkHmacContext, ciphertextChunk, kSETOCryptorV3NonceLength + payloadLength); // nonce + payload
+	CCHmacFinal(&chunkHmacContext, calculatedMac);
+
+	// constant time comparison of chunk mac:
+	unsigned char *expectedMac = (unsigned char *)&ciphertextChunk[kSETOCryptorV3NonceLength + payloadLength];
+	return compare_bytes(calculatedMac, expectedMac, CC_SHA256_DIGEST_LENGTH);
+}
+
 #pragma mark - File Size Calculation
 
 - (NSUInteger)ciphertextSizeFromCleartextSize:(NSUInteger)cleartextSize {
@@ -0,0 +1,30 @@
+//
+//  SETOCryptorV3_Private.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOCryptorV3.h"
+
+#import <openssl/evp.h>
+
+extern int const kSETOCryptorV3NonceLength;
+extern int const kSETOCryptorV3HeaderLength;
+extern int const kSETOCryptorV3HeaderPayloadLength;
+extern int const kSETOCryptorV3ChunkPayloadLength;
+
+/**
+ *  File header and chunk primitives of @c SETOCryptorV3, shared with the streaming decryptor. A cipher context is initialized once per file key and only gets the nonce per chunk.
+ */
+@interface SETOCryptorV3 ()
+
+- (BOOL)decryptFileHeader:(const unsigned char *)header fileSize:(uint64_t *)fileSize fileKey:(unsigned char *)fileKey;
+- (BOOL)isAuthenticFileHeader:(const unsigned char *)header;
+
+- (BOOL)initCipherContext:(EVP_CIPHER_CTX *)ctx withFileKey:(const unsigned char *)fileKey;
+- (BOOL)decryptChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength cipherContext:(EVP_CIPHER_CTX *)ctx cleartextChunk:(unsigned char *)cleartextChunk cleartextChunkLength:(int *)cleartextChunkLength;
+- (BOOL)isAuthenticChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength chunkNumber:(uint64_t)chunkNumber headerIv:(const unsigned char *)headerIv;
+
+@end
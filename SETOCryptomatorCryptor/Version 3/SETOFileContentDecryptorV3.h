@@ -0,0 +1,18 @@
+//
+//  SETOFileContentDecryptorV3.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentDecryptor.h"
+#import "SETOCryptor.h"
+
+@class SETOCryptorV3;
+
+@interface SETOFileContentDecryptorV3 : SETOFileContentDecryptor
+
+- (instancetype)initWithCryptor:(SETOCryptorV3 *)cryptor source:(SETOCryptorReadCallback)source;
+
+@end
@@ -0,0 +1,105 @@
+//
+//  SETOFileContentDecryptorV3.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentDecryptorV3.h"
+#import "SETOFileContentDecryptor_Private.h"
+#import "SETOCryptorV3_Private.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+@interface SETOFileContentDecryptorV3 ()
+@property (nonatomic, strong) SETOCryptorV3 *cryptor;
+@property (nonatomic, strong) NSMutableData *header;
+@property (nonatomic, strong) NSMutableData *ciphertextChunk;
+@property (nonatomic, assign) uint64_t fileSize;
+@property (nonatomic, assign) uint64_t bytesDecrypted;
+@property (nonatomic, assign) uint64_t chunkNumber;
+@property (nonatomic, assign) BOOL headerRead;
+@end
+
+@implementation SETOFileContentDecryptorV3 {
+	EVP_CIPHER_CTX _cipherContext;
+}
+
+#pragma mark - Initialization
+
+- (instancetype)initWithCryptor:(SETOCryptorV3 *)cryptor source:(SETOCryptorReadCallback)source {
+	NSParameterAssert(cryptor);
+	if (self = [super initWithSource:source]) {
+		self.cryptor = cryptor;
+		self.header = [NSMutableData dataWithLength:kSETOCryptorV3HeaderLength];
+		self.ciphertextChunk = [NSMutableData dataWithLength:kSETOCryptorV3NonceLength + kSETOCryptorV3ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH];
+		EVP_CIPHER_CTX_init(&_cipherContext);
+	}
+	return self;
+}
+
+- (void)dealloc {
+	EVP_CIPHER_CTX_cleanup(&_cipherContext);
+}
+
+#pragma mark - Streaming File Content Decryption
+
+- (NSData *)readChunkWithError:(NSError **)error {
+	if (self.failed) {
+		return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+	}
+
+	// read, authenticate and decrypt file header on first use:
+	if (!self.headerRead) {
+		NSInteger headerLength = [self readBytes:self.header.mutableBytes length:self.header.length];
+		uint64_t fileSize = 0;
+		if (headerLength < 0) {
+			return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+		} else if (headerLength != kSETOCryptorV3HeaderLength) {
+			return [self failWithCode:SETOCryptorCorruptedFileHeaderError error:error];
+		} else if (![self.cryptor isAuthenticFileHeader:self.header.bytes]) {
+			return [self failWithCode:SETOCryptorAuthenticationFailedError error:error];
+		} else if (![self.cryptor decryptFileHeader:self.header.bytes fileSize:&fileSize fileKey:self.fileKey.mutableBytes]) {
+			return [self failWithCode:SETOCryptorCorruptedFileHeaderError error:error];
+		}
+
+		// expand the file key once, chunks only set their nonce:
+		BOOL cipherContextInitialized = [self.cryptor initCipherContext:&_cipherContext withFileKey:self.fileKey.bytes];
+		memset_s(self.fileKey.mutableBytes, self.fileKey.length, 0, self.fileKey.length);
+		if (!cipherContextInitialized) {
+			return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+		}
+		self.fileSize = fileSize;
+		self.headerRead = YES;
+	}
+
+	// the file size is known from the header, so random padding behind it is never read:
+	if (self.bytesDecrypted >= self.fileSize) {
+		return [NSData data];
+	}
+
+	// read chunk, the source must not end before the file size is reached:
+	NSInteger inputLength = [self readBytes:self.ciphertextChunk.mutableBytes length:self.ciphertextChunk.length];
+	if (inputLength < kSETOCryptorV3NonceLength + CC_SHA256_DIGEST_LENGTH) {
+		return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+	}
+
+	// authenticate chunk:
+	if (![self.cryptor isAuthenticChunk:self.ciphertextChunk.bytes length:(int)inputLength chunkNumber:self.chunkNumber headerIv:self.header.bytes]) {
+		return [self failWithCode:SETOCryptorAuthenticationFailedError error:error];
+	}
+
+	// decrypt chunk and drop padding:
+	NSMutableData *cleartextChunk = [NSMutableData dataWithLength:kSETOCryptorV3ChunkPayloadLength];
+	int cleartextChunkLength = 0;
+	if (![self.cryptor decryptChunk:self.ciphertextChunk.bytes length:(int)inputLength cipherContext:&_cipherContext cleartextChunk:cleartextChunk.mutableBytes cleartextChunkLength:&cleartextChunkLength]) {
+		return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+	}
+	cleartextChunk.length = (NSUInteger)MIN((uint64_t)cleartextChunkLength, self.fileSize - self.bytesDecrypted);
+	self.bytesDecrypted += cleartextChunk.length;
+	self.chunkNumber++;
+	return cleartextChunk;
+}
+
+@end
@@ -7,13 +7,19 @@
 //
 
 #import "SETOCryptorV5.h"
+#import "SETOCryptorV5_Private.h"
 #import "SETOMasterKey.h"
 
 #import "SETOCryptoSupport.h"
+#import "SETOFileContentDecryptorV5.h"
+#import "SETOFileContentEncryptorV5.h"
+#import "SETOFileHandle.h"
+#import "SETOMasterKeyContext.h"
 
 #import <CommonCrypto/CommonDigest.h>
 #import <CommonCrypto/CommonHMAC.h>
 #import <openssl/evp.h>
+#import <stdatomic.h>
 
 #pragma mark -
 
@@ -23,8 +29,11 @@ int const kSETOCryptorV5HeaderLength = 88;
 int const kSETOCryptorV5HeaderPayloadLength = 40;
 int const kSETOCryptorV5ChunkPayloadLength = 32 * 1024;
 
+typedef BOOL (^SETOCryptorV5ChunkTransform)(const unsigned char *input, int inputLength, uint64_t chunkNumber, unsigned char *output, int *outputLength);
+
 @interface SETOCryptorV5 ()
 @property (nonatomic, strong) SETOMasterKey *masterKey;
+@property (nonatomic, strong) SETOMasterKeyContext *masterKeyContext;
 @end
 
 @implementation SETOCryptorV5
@@ -36,293 +45,635 @@ int const kSETOCryptorV5ChunkPayloadLength = 32 * 1024;
 	NSParameterAssert(outPath);
 	NSParameterAssert(callback);
 
-	// read cleartext file size:
-	NSError *filesAttributesError;
-	NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:inPath error:&filesAttributesError];
-	if (filesAttributesError) {
-		callback(filesAttributesError);
+	// open cleartext input and read its file size:
+	NSError *error;
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:inPath error:&error];
+	if (!input) {
+		callback(error);
 		return;
 	}
-	uint64_t fileSize = [fileAttributes fileSize];
+	uint64_t fileSize = input.fileSize;
 
 	// init progress:
-	uint64_t bytesProcessed = 0;
 	if (progressCallback) {
 		progressCallback(0.0);
 	}
 
-	// allocate file header buffer:
+	// create file header with random iv and random file key:
 	unsigned char header[kSETOCryptorV5HeaderLength];
-
-	// create random iv:
-	if (SecRandomCopyBytes(kSecRandomDefault, 16, header) == -1) {
+	unsigned char fileKeyBytes[32];
+	if (![self createFileHeader:header fileKey:fileKeyBytes]) {
+		[input closeFile];
 		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 		return;
 	}
-	unsigned char *iv = &header[0];
-	unsigned char *ciphertextHeaderPayload = &header[16];
-
-	// create random file key:
-	unsigned char fileKey[32];
-	if (SecRandomCopyBytes(kSecRandomDefault, 32, fileKey) == -1) {
+	const unsigned char *iv = &header[0];
+	const unsigned char *fileKey = fileKeyBytes;
+
+	// open ciphertext output and write header:
+	SETOFileHandle *output = [SETOFileHandle fileHandleForWritingAtPath:outPath error:&error];
+	if (!output) {
+		[input closeFile];
+		callback(error);
+		return;
+	}
+	if (![output writeBytes:header length:sizeof(header) atOffset:0]) {
+		[input closeFile];
+		[output closeFile];
 		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
 		return;
 	}
 
-	// encrypt header data:
-	unsigned char cleartextHeaderPayload[kSETOCryptorV5HeaderPayloadLength];
-	fill_bytes(cleartextHeaderPayload, 0xFF, 0, 8);
-	memcpy(&cleartextHeaderPayload[8], fileKey, sizeof(fileKey));
-	{
-		const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
-		EVP_CIPHER_CTX ctx;
-		EVP_CIPHER_CTX_init(&ctx);
-		EVP_CIPHER_CTX_set_padding(&ctx, 0);
-		EVP_EncryptInit_ex(&ctx, ctrCipher, NULL, self.masterKey.aesMasterKey.bytes, iv);
-		int bytesEncrypted = 0;
-		int encryptStatus = EVP_EncryptUpdate(&ctx, ciphertextHeaderPayload, &bytesEncrypted, cleartextHeaderPayload, kSETOCryptorV5HeaderPayloadLength);
-		if (encryptStatus == 0 || bytesEncrypted != kSETOCryptorV5HeaderPayloadLength) {
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
-			return;
+	// encrypt then mac content:
+	SETOCryptorV5ChunkTransform encryptChunk = ^BOOL(const unsigned char *cleartextChunk, int cleartextChunkLength, uint64_t chunkNumber, unsigned char *ciphertextChunk, int *ciphertextChunkLength) {
+		int payloadLength = (int)MIN(fileSize - chunkNumber * kSETOCryptorV5ChunkPayloadLength, kSETOCryptorV5ChunkPayloadLength);
+		if (cleartextChunkLength != payloadLength) {
+			return NO;
 		}
-		EVP_CIPHER_CTX_cleanup(&ctx);
+		*ciphertextChunkLength = kSETOCryptorV5NonceLength + payloadLength + CC_SHA256_DIGEST_LENGTH;
+		return [self encryptChunk:cleartextChunk length:cleartextChunkLength chunkNumber:chunkNumber headerNonce:iv fileKey:fileKey ciphertextChunk:ciphertextChunk];
+	};
+	int ciphertextChunkLength = kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
+	uint64_t chunkCount = (fileSize + kSETOCryptorV5ChunkPayloadLength - 1) / kSETOCryptorV5ChunkPayloadLength;
+	error = [self processChunks:chunkCount ofFile:input atOffset:0 chunkLength:kSETOCryptorV5ChunkPayloadLength toFile:output atOffset:kSETOCryptorV5HeaderLength chunkLength:ciphertextChunkLength errorCode:SETOCryptorEncryptionFailedError progress:progressCallback transform:encryptChunk];
+	[input closeFile];
+	[output closeFile];
+	if (error) {
+		callback(error);
+		return;
 	}
 
-	// calculate mac over file header:
-	CCHmacContext headerHmacContext;
-	CCHmacInit(&headerHmacContext, kCCHmacAlgSHA256, self.masterKey.macMasterKey.bytes, self.masterKey.macMasterKey.length);
-	CCHmacUpdate(&headerHmacContext, header, 56);
-	CCHmacFinal(&headerHmacContext, &header[56]);
+	// done:
+	if (progressCallback) {
+		progressCallback(1.0);
+	}
+	callback(nil);
+}
 
-	// open cleartext input stream:
-	NSInputStream *input = [NSInputStream inputStreamWithFileAtPath:inPath];
-	[input scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[input open];
+- (void)decryptFileAtPath:(NSString *)inPath toPath:(NSString *)outPath callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback {
+	NSParameterAssert(inPath);
+	NSParameterAssert(outPath);
+	NSParameterAssert(callback);
 
-	// open ciphertext output stream and write header:
-	NSOutputStream *output = [NSOutputStream outputStreamToFileAtPath:outPath append:NO];
-	[output scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[output open];
-	[output write:header maxLength:sizeof(header)];
+	// open ciphertext input and read its file size:
+	NSError *error;
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:inPath error:&error];
+	if (!input) {
+		callback(error);
+		return;
+	}
+	uint64_t fileSize = input.fileSize;
 
-	// encrypt then mac content + padding:
-	const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
-	EVP_CIPHER_CTX ctx;
-	EVP_CIPHER_CTX_init(&ctx);
-	EVP_CIPHER_CTX_set_padding(&ctx, 0);
-	uint64_t chunkNumber = 0;
-	while (input.hasBytesAvailable) {
+	// read file header:
+	unsigned char header[kSETOCryptorV5HeaderLength];
+	NSInteger inputLength = [input readBytes:header length:sizeof(header) atOffset:0];
+	if (inputLength != sizeof(header)) {
+		[input closeFile];
+		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
+		return;
+	}
+
+	// decrypt header data and extract file key:
+	unsigned char fileKeyBytes[32];
+	if (![self decryptFileHeader:header fileKey:fileKeyBytes]) {
+		[input closeFile];
+		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
+		return;
+	}
+	const unsigned char *fileKey = fileKeyBytes;
+
+	// initialize bytes processed:
+	if (progressCallback) {
+		progressCallback(0.0);
+	}
+
+	// open cleartext output:
+	SETOFileHandle *output = [SETOFileHandle fileHandleForWritingAtPath:outPath error:&error];
+	if (!output) {
+		[input closeFile];
+		callback(error);
+		return;
+	}
+
+	// decrypt content (ignoring chunk macs, assuming it's authentic):
+	SETOCryptorV5ChunkTransform decryptChunk = ^BOOL(const unsigned char *ciphertextChunk, int ciphertextChunkLength, uint64_t chunkNumber, unsigned char *cleartextChunk, int *cleartextChunkLength) {
+		return [self decryptChunk:ciphertextChunk length:ciphertextChunkLength fileKey:fileKey cleartextChunk:cleartextChunk cleartextChunkLength:cleartextChunkLength];
+	};
+	int ciphertextChunkLength = kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
+	uint64_t chunkCount = (fileSize - kSETOCryptorV5HeaderLength + ciphertextChunkLength - 1) / ciphertextChunkLength;
+	error = [self processChunks:chunkCount ofFile:input atOffset:kSETOCryptorV5HeaderLength chunkLength:ciphertextChunkLength toFile:output atOffset:0 chunkLength:kSETOCryptorV5ChunkPayloadLength errorCode:SETOCryptorDecryptionFailedError progress:progressCallback transform:decryptChunk];
+	[input closeFile];
+	[output closeFile];
+	if (error) {
+		callback(error);
+		return;
+	}
+
+	// done:
+	if (progressCallback) {
+		progressCallback(1.0);
+	}
+	callback(nil);
+}
+
+#pragma mark - Random Access File Content Decryption
+
+- (NSData *)decryptRange:(NSRange)range ofFileAtPath:(NSString *)path error:(NSError **)error {
+	NSParameterAssert(path);
+
+	// open ciphertext file:
+	SETOFileHandle *fileHandle = [SETOFileHandle fileHandleForReadingAtPath:path error:error];
+	if (!fileHandle) {
+		return nil;
+	}
+
+	// read file header and cleartext size:
+	unsigned char header[kSETOCryptorV5HeaderLength];
+	unsigned char fileKey[32];
+	uint64_t cleartextSize = 0;
+	if (![self readFileHeader:header fileKey:fileKey cleartextSize:&cleartextSize fromFileHandle:fileHandle error:error]) {
+		[fileHandle closeFile];
+		return nil;
+	}
+
+	// clamp range to cleartext size:
+	if (range.location >= cleartextSize || range.length == 0) {
+		[fileHandle closeFile];
+		return [NSData data];
+	}
+	uint64_t rangeEnd = (range.length < cleartextSize - range.location) ? NSMaxRange(range) : cleartextSize;
+
+	// authenticate and decrypt affected chunks:
+	NSMutableData *cleartext = [NSMutableData dataWithCapacity:(NSUInteger)(rangeEnd - range.location)];
+	unsigned char cleartextChunk[kSETOCryptorV5ChunkPayloadLength];
+	uint64_t firstChunkNumber = range.location / kSETOCryptorV5ChunkPayloadLength;
+	uint64_t lastChunkNumber = (rangeEnd - 1) / kSETOCryptorV5ChunkPayloadLength;
+	for (uint64_t chunkNumber = firstChunkNumber; chunkNumber <= lastChunkNumber; chunkNumber++) {
 		// read chunk:
-		int cleartextChunkLength = kSETOCryptorV5ChunkPayloadLength;
-		unsigned char cleartextChunk[cleartextChunkLength];
-		int inputLength = (int)[input read:cleartextChunk maxLength:cleartextChunkLength];
-		if (inputLength == 0) {
-			continue;
-		} else if (inputLength < 0) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
-			return;
+		int cleartextChunkLength = 0;
+		if (![self readChunk:chunkNumber fromFileHandle:fileHandle header:header fileKey:fileKey cleartextChunk:cleartextChunk cleartextChunkLength:&cleartextChunkLength error:error]) {
+			[fileHandle closeFile];
+			return nil;
 		}
 
-		// calculate payload length:
-		int payloadLength = (int)MIN(fileSize - bytesProcessed, kSETOCryptorV5ChunkPayloadLength);
+		// append the part of the chunk within range:
+		uint64_t chunkStart = chunkNumber * kSETOCryptorV5ChunkPayloadLength;
+		uint64_t from = MAX(range.location, chunkStart) - chunkStart;
+		uint64_t to = MIN(rangeEnd, chunkStart + cleartextChunkLength) - chunkStart;
+		[cleartext appendBytes:&cleartextChunk[from] length:(NSUInteger)(to - from)];
+	}
 
-		// init encryption:
-		int ciphertextChunkLength = kSETOCryptorV5NonceLength + payloadLength + CC_SHA256_DIGEST_LENGTH;
-		unsigned char ciphertextChunk[ciphertextChunkLength + kSETOCryptorV5BlockSize];
-		unsigned char *nonce = &ciphertextChunk[0];
-		if (SecRandomCopyBytes(kSecRandomDefault, 16, nonce) == -1) {
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
-			return;
-		}
-		EVP_EncryptInit_ex(&ctx, ctrCipher, NULL, fileKey, nonce);
-
-		// encrypt chunk:
-		int bytesEncrypted;
-		unsigned char *payload = &ciphertextChunk[16];
-		int encryptStatus = EVP_EncryptUpdate(&ctx, payload, &bytesEncrypted, cleartextChunk, inputLength);
-		if (encryptStatus == 0 || bytesEncrypted != payloadLength) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
-			return;
+	// done:
+	[fileHandle closeFile];
+	return cleartext;
+}
+
+#pragma mark - Random Access File Content Encryption
+
+- (BOOL)writeData:(NSData *)data toFileAtPath:(NSString *)path atOffset:(NSUInteger)offset error:(NSError **)error {
+	NSParameterAssert(data);
+	NSParameterAssert(path);
+
+	// open ciphertext file:
+	SETOFileHandle *fileHandle = [SETOFileHandle fileHandleForUpdatingAtPath:path error:error];
+	if (!fileHandle) {
+		return NO;
+	}
+
+	// read file header and cleartext size:
+	unsigned char header[kSETOCryptorV5HeaderLength];
+	unsigned char fileKey[32];
+	uint64_t cleartextSize = 0;
+	if (![self readFileHeader:header fileKey:fileKey cleartextSize:&cleartextSize fromFileHandle:fileHandle error:error]) {
+		[fileHandle closeFile];
+		return NO;
+	}
+
+	// writing must not leave a gap behind the end of file:
+	if (offset > cleartextSize) {
+		[fileHandle closeFile];
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
 		}
+		return NO;
+	}
 
-		// authenticate ciphertext chunk:
-		unsigned char *chunkMac = &ciphertextChunk[kSETOCryptorV5NonceLength + bytesEncrypted];
-		unsigned char chunkNumberBytes[sizeof(uint64_t)] = {0};
-		long_to_big_endian_bytes(chunkNumber, chunkNumberBytes);
-		CCHmacContext chunkHmacContext;
-		CCHmacInit(&chunkHmacContext, kCCHmacAlgSHA256, self.masterKey.macMasterKey.bytes, self.masterKey.macMasterKey.length);
-		CCHmacUpdate(&chunkHmacContext, iv, 16);
-		CCHmacUpdate(&chunkHmacContext, chunkNumberBytes, sizeof(chunkNumberBytes));
-		CCHmacUpdate(&chunkHmacContext, nonce, 16);
-		CCHmacUpdate(&chunkHmacContext, payload, bytesEncrypted);
-		CCHmacFinal(&chunkHmacContext, chunkMac);
-
-		// write ciphertext chunk:
-		int bytesWritten = (int)[output write:ciphertextChunk maxLength:ciphertextChunkLength];
-		if (bytesWritten != ciphertextChunkLength) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil]);
-			return;
+	// rewrite affected chunks:
+	BOOL success = [self writeData:data atOffset:offset toFileHandle:fileHandle header:header fileKey:fileKey cleartextSize:cleartextSize error:error];
+	[fileHandle closeFile];
+	return success;
+}
+
+- (BOOL)writeData:(NSData *)data atOffset:(uint64_t)offset toFileHandle:(SETOFileHandle *)fileHandle header:(const unsigned char *)header fileKey:(const unsigned char *)fileKey cleartextSize:(uint64_t)cleartextSize error:(NSError **)error {
+	if (data.length == 0) {
+		return YES;
+	}
+	int ciphertextChunkLength = kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
+	unsigned char cleartextChunk[kSETOCryptorV5ChunkPayloadLength];
+	unsigned char ciphertextChunk[ciphertextChunkLength];
+	uint64_t writeEnd = offset + data.length;
+	uint64_t firstChunkNumber = offset / kSETOCryptorV5ChunkPayloadLength;
+	for (uint64_t chunkNumber = firstChunkNumber; chunkNumber * kSETOCryptorV5ChunkPayloadLength < writeEnd; chunkNumber++) {
+		uint64_t chunkStart = chunkNumber * kSETOCryptorV5ChunkPayloadLength;
+		int existingLength = (chunkStart < cleartextSize) ? (int)MIN(cleartextSize - chunkStart, kSETOCryptorV5ChunkPayloadLength) : 0;
+		int from = (int)(MAX(offset, chunkStart) - chunkStart);
+		int to = (int)(MIN(writeEnd, chunkStart + kSETOCryptorV5ChunkPayloadLength) - chunkStart);
+
+		// read existing chunk, unless it gets overwritten completely:
+		if (existingLength > 0 && (from > 0 || to < existingLength)) {
+			int cleartextChunkLength = 0;
+			if (![self readChunk:chunkNumber fromFileHandle:fileHandle header:header fileKey:fileKey cleartextChunk:cleartextChunk cleartextChunkLength:&cleartextChunkLength error:error]) {
+				return NO;
+			}
 		}
 
-		// progress:
-		bytesProcessed += payloadLength;
-		chunkNumber++;
-		if (progressCallback) {
-			progressCallback((CGFloat)bytesProcessed / fileSize);
+		// patch chunk:
+		memcpy(&cleartextChunk[from], (const unsigned char *)data.bytes + (chunkStart + from - offset), to - from);
+		int cleartextChunkLength = MAX(existingLength, to);
+
+		// encrypt chunk with new nonce and write it in place:
+		if (![self encryptChunk:cleartextChunk length:cleartextChunkLength chunkNumber:chunkNumber headerNonce:header fileKey:fileKey ciphertextChunk:ciphertextChunk]) {
+			if (error) {
+				*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+			}
+			return NO;
+		}
+		if (![fileHandle writeBytes:ciphertextChunk length:kSETOCryptorV5NonceLength + cleartextChunkLength + CC_SHA256_DIGEST_LENGTH atOffset:kSETOCryptorV5HeaderLength + chunkNumber * ciphertextChunkLength]) {
+			if (error) {
+				*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+			}
+			return NO;
 		}
 	}
-	EVP_CIPHER_CTX_cleanup(&ctx);
+	return YES;
+}
 
-	// done:
-	[input close];
-	[output close];
-	if (progressCallback) {
-		progressCallback(1.0);
+- (BOOL)appendData:(NSData *)data toFileAtPath:(NSString *)path error:(NSError **)error {
+	NSParameterAssert(data);
+	NSParameterAssert(path);
+
+	// open ciphertext file:
+	SETOFileHandle *fileHandle = [SETOFileHandle fileHandleForUpdatingAtPath:path error:error];
+	if (!fileHandle) {
+		return NO;
 	}
-	callback(nil);
+
+	// read file header and cleartext size:
+	unsigned char header[kSETOCryptorV5HeaderLength];
+	unsigned char fileKey[32];
+	uint64_t cleartextSize = 0;
+	if (![self readFileHeader:header fileKey:fileKey cleartextSize:&cleartextSize fromFileHandle:fileHandle error:error]) {
+		[fileHandle closeFile];
+		return NO;
+	}
+
+	// rewrite trailing partial chunk and write new chunks:
+	BOOL success = [self writeData:data atOffset:cleartextSize toFileHandle:fileHandle header:header fileKey:fileKey cleartextSize:cleartextSize error:error];
+	[fileHandle closeFile];
+	return success;
 }
 
-- (void)decryptFileAtPath:(NSString *)inPath toPath:(NSString *)outPath callback:(SETOCryptorCompletionCallback)callback progress:(SETOCryptorProgressCallback)progressCallback {
-	NSParameterAssert(inPath);
-	NSParameterAssert(outPath);
-	NSParameterAssert(callback);
+- (BOOL)truncateFileAtPath:(NSString *)path toCleartextSize:(NSUInteger)size error:(NSError **)error {
+	NSParameterAssert(path);
 
-	// read ciphertext file size:
-	NSError *filesAttributesError;
-	NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:inPath error:&filesAttributesError];
-	if (filesAttributesError) {
-		callback(filesAttributesError);
-		return;
+	// open ciphertext file:
+	SETOFileHandle *fileHandle = [SETOFileHandle fileHandleForUpdatingAtPath:path error:error];
+	if (!fileHandle) {
+		return NO;
+	}
+
+	// read file header and cleartext size:
+	unsigned char header[kSETOCryptorV5HeaderLength];
+	unsigned char fileKey[32];
+	uint64_t cleartextSize = 0;
+	if (![self readFileHeader:header fileKey:fileKey cleartextSize:&cleartextSize fromFileHandle:fileHandle error:error]) {
+		[fileHandle closeFile];
+		return NO;
+	}
+
+	// extend file with zeros chunk by chunk:
+	if (size >= cleartextSize) {
+		NSData *zeros = [NSMutableData dataWithLength:kSETOCryptorV5ChunkPayloadLength];
+		while (cleartextSize < size) {
+			NSUInteger length = (NSUInteger)MIN(size - cleartextSize, kSETOCryptorV5ChunkPayloadLength - cleartextSize % kSETOCryptorV5ChunkPayloadLength);
+			if (![self writeData:[zeros subdataWithRange:NSMakeRange(0, length)] atOffset:cleartextSize toFileHandle:fileHandle header:header fileKey:fileKey cleartextSize:cleartextSize error:error]) {
+				[fileHandle closeFile];
+				return NO;
+			}
+			cleartextSize += length;
+		}
+		[fileHandle closeFile];
+		return YES;
 	}
-	uint64_t fileSize = [fileAttributes fileSize];
 
-	// open ciphertext input stream:
-	NSInputStream *input = [NSInputStream inputStreamWithFileAtPath:inPath];
-	[input scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[input open];
+	// rewrite new trailing partial chunk:
+	int trailingLength = size % kSETOCryptorV5ChunkPayloadLength;
+	if (trailingLength > 0) {
+		uint64_t chunkNumber = size / kSETOCryptorV5ChunkPayloadLength;
+		unsigned char cleartextChunk[kSETOCryptorV5ChunkPayloadLength];
+		unsigned char ciphertextChunk[kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH];
+		int cleartextChunkLength = 0;
+		if (![self readChunk:chunkNumber fromFileHandle:fileHandle header:header fileKey:fileKey cleartextChunk:cleartextChunk cleartextChunkLength:&cleartextChunkLength error:error]) {
+			[fileHandle closeFile];
+			return NO;
+		}
+		if (![self encryptChunk:cleartextChunk length:trailingLength chunkNumber:chunkNumber headerNonce:header fileKey:fileKey ciphertextChunk:ciphertextChunk] || ![fileHandle writeBytes:ciphertextChunk length:kSETOCryptorV5NonceLength + trailingLength + CC_SHA256_DIGEST_LENGTH atOffset:kSETOCryptorV5HeaderLength + chunkNumber * sizeof(ciphertextChunk)]) {
+			[fileHandle closeFile];
+			if (error) {
+				*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+			}
+			return NO;
+		}
+	}
+
+	// trim remaining chunks:
+	BOOL truncated = [fileHandle truncateAtOffset:kSETOCryptorV5HeaderLength + [self ciphertextSizeFromCleartextSize:size]];
+	[fileHandle closeFile];
+	if (!truncated && error) {
+		*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+	}
+	return truncated;
+}
+
+#pragma mark - Streaming File Content Encryption and Decryption
+
+- (SETOFileContentEncryptor *)fileContentEncryptorWithError:(NSError **)error {
+	return [[SETOFileContentEncryptorV5 alloc] initWithCryptor:self error:error];
+}
 
+- (SETOFileContentDecryptor *)fileContentDecryptorWithSource:(SETOCryptorReadCallback)source error:(NSError **)error {
+	NSParameterAssert(source);
+	return [[SETOFileContentDecryptorV5 alloc] initWithCryptor:self source:source];
+}
+
+#pragma mark - Random Access Support
+
+- (BOOL)readFileHeader:(unsigned char *)header fileKey:(unsigned char *)fileKey cleartextSize:(uint64_t *)cleartextSize fromFileHandle:(SETOFileHandle *)fileHandle error:(NSError **)error {
 	// read file header:
-	unsigned char header[kSETOCryptorV5HeaderLength];
-	int inputLength = (int)[input read:header maxLength:sizeof(header)];
-	if (inputLength != sizeof(header)) {
-		[input close];
-		callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
-		return;
+	if ([fileHandle readBytes:header length:kSETOCryptorV5HeaderLength atOffset:0] != kSETOCryptorV5HeaderLength) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil];
+		}
+		return NO;
 	}
 
-	// iv is at the beginning of file header:
+	// authenticate file header:
+	if (![self isAuthenticFileHeader:header]) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorAuthenticationFailedError userInfo:nil];
+		}
+		return NO;
+	}
+
+	// decrypt file header:
+	if (![self decryptFileHeader:header fileKey:fileKey]) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil];
+		}
+		return NO;
+	}
+
+	// calculate cleartext size:
+	uint64_t ciphertextSize = fileHandle.fileSize - kSETOCryptorV5HeaderLength;
+	NSUInteger calculatedCleartextSize = [self cleartextSizeFromCiphertextSize:(NSUInteger)ciphertextSize];
+	if (calculatedCleartextSize == NSUIntegerMax) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil];
+		}
+		return NO;
+	}
+	*cleartextSize = calculatedCleartextSize;
+	return YES;
+}
+
+- (BOOL)readChunk:(uint64_t)chunkNumber fromFileHandle:(SETOFileHandle *)fileHandle header:(const unsigned char *)header fileKey:(const unsigned char *)fileKey cleartextChunk:(unsigned char *)cleartextChunk cleartextChunkLength:(int *)cleartextChunkLength error:(NSError **)error {
+	// read chunk:
+	int ciphertextChunkLength = kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
+	unsigned char ciphertextChunk[ciphertextChunkLength];
+	int inputLength = (int)[fileHandle readBytes:ciphertextChunk length:ciphertextChunkLength atOffset:kSETOCryptorV5HeaderLength + chunkNumber * ciphertextChunkLength];
+
+	// authenticate chunk:
+	if (![self isAuthenticChunk:ciphertextChunk length:inputLength chunkNumber:chunkNumber headerNonce:header]) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorAuthenticationFailedError userInfo:nil];
+		}
+		return NO;
+	}
+
+	// decrypt chunk:
+	if (![self decryptChunk:ciphertextChunk length:inputLength fileKey:fileKey cleartextChunk:cleartextChunk cleartextChunkLength:cleartextChunkLength]) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil];
+		}
+		return NO;
+	}
+	return YES;
+}
+
+#pragma mark - File Header
+
+- (BOOL)createFileHeader:(unsigned char *)header fileKey:(unsigned char *)fileKey {
+	// create random iv:
+	if (SecRandomCopyBytes(kSecRandomDefault, kSETOCryptorV5NonceLength, header) == -1) {
+		return NO;
+	}
 	unsigned char *iv = &header[0];
 	unsigned char *ciphertextHeaderPayload = &header[16];
 
+	// create random file key:
+	if (SecRandomCopyBytes(kSecRandomDefault, 32, fileKey) == -1) {
+		return NO;
+	}
+
+	// encrypt header data:
+	unsigned char cleartextHeaderPayload[kSETOCryptorV5HeaderPayloadLength];
+	fill_bytes(cleartextHeaderPayload, 0xFF, 0, 8);
+	memcpy(&cleartextHeaderPayload[8], fileKey, 32);
+	BOOL encrypted = [self.masterKeyContext cryptHeaderPayload:cleartextHeaderPayload length:kSETOCryptorV5HeaderPayloadLength iv:iv output:ciphertextHeaderPayload];
+	memset_s(cleartextHeaderPayload, sizeof(cleartextHeaderPayload), 0, sizeof(cleartextHeaderPayload));
+	if (!encrypted) {
+		return NO;
+	}
+
+	// calculate mac over file header:
+	CCHmacContext headerHmacContext;
+	[self.masterKeyContext getHmacContext:&headerHmacContext];
+	CCHmacUpdate(&headerHmacContext, header, 56);
+	CCHmacFinal(&headerHmacContext, &header[56]);
+	return YES;
+}
+
+- (BOOL)decryptFileHeader:(const unsigned char *)header fileKey:(unsigned char *)fileKey {
+	// iv is at the beginning of file header:
+	const unsigned char *iv = &header[0];
+	const unsigned char *ciphertextHeaderPayload = &header[16];
+
 	// decrypt header data:
-	unsigned char cleartextHeaderPayload[kSETOCryptorV5HeaderPayloadLength + kSETOCryptorV5BlockSize];
-	{
-		const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
-		EVP_CIPHER_CTX ctx;
-		EVP_CIPHER_CTX_init(&ctx);
-		EVP_CIPHER_CTX_set_padding(&ctx, 0);
-		EVP_DecryptInit_ex(&ctx, ctrCipher, NULL, self.masterKey.aesMasterKey.bytes, iv);
-		int bytesDecrypted = 0;
-		int decryptStatus = EVP_DecryptUpdate(&ctx, cleartextHeaderPayload, &bytesDecrypted, ciphertextHeaderPayload, kSETOCryptorV5HeaderPayloadLength);
-		if (decryptStatus == 0 || bytesDecrypted != kSETOCryptorV5HeaderPayloadLength) {
-			[input close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorCorruptedFileHeaderError userInfo:nil]);
-			return;
-		}
-		EVP_CIPHER_CTX_cleanup(&ctx);
+	unsigned char cleartextHeaderPayload[kSETOCryptorV5HeaderPayloadLength];
+	if (![self.masterKeyContext cryptHeaderPayload:ciphertextHeaderPayload length:kSETOCryptorV5HeaderPayloadLength iv:iv output:cleartextHeaderPayload]) {
+		memset_s(cleartextHeaderPayload, sizeof(cleartextHeaderPayload), 0, sizeof(cleartextHeaderPayload));
+		return NO;
 	}
 
 	// extract file key:
-	unsigned char *fileKey = &cleartextHeaderPayload[8];
+	memcpy(fileKey, &cleartextHeaderPayload[8], 32);
+	memset_s(cleartextHeaderPayload, sizeof(cleartextHeaderPayload), 0, sizeof(cleartextHeaderPayload));
+	return YES;
+}
 
-	// initialize bytes processed:
-	uint64_t bytesProcessed = 0;
-	if (progressCallback) {
-		progressCallback(0.0);
+- (BOOL)isAuthenticFileHeader:(const unsigned char *)header {
+	// calculate mac over file header:
+	unsigned char calculatedHeaderMac[CC_SHA256_DIGEST_LENGTH];
+	CCHmacContext headerHmacContext;
+	[self.masterKeyContext getHmacContext:&headerHmacContext];
+	CCHmacUpdate(&headerHmacContext, header, 56);
+	CCHmacFinal(&headerHmacContext, calculatedHeaderMac);
+
+	// constant time comparison of header mac:
+	unsigned char *expectedHeaderMac = (unsigned char *)&header[56];
+	return compare_bytes(calculatedHeaderMac, expectedHeaderMac, CC_SHA256_DIGEST_LENGTH);
+}
+
+#pragma mark - File Content Chunks
+
+- (BOOL)encryptChunk:(const unsigned char *)cleartextChunk length:(int)cleartextChunkLength chunkNumber:(uint64_t)chunkNumber headerNonce:(const unsigned char *)headerNonce fileKey:(const unsigned char *)fileKey ciphertextChunk:(unsigned char *)ciphertextChunk {
+	// create random nonce:
+	unsigned char *nonce = &ciphertextChunk[0];
+	if (SecRandomCopyBytes(kSecRandomDefault, kSETOCryptorV5NonceLength, nonce) == -1) {
+		return NO;
+	}
+
+	// encrypt chunk:
+	unsigned char *payload = &ciphertextChunk[kSETOCryptorV5NonceLength];
+	const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
+	EVP_CIPHER_CTX ctx;
+	EVP_CIPHER_CTX_init(&ctx);
+	EVP_CIPHER_CTX_set_padding(&ctx, 0);
+	EVP_EncryptInit_ex(&ctx, ctrCipher, NULL, fileKey, nonce);
+	int bytesEncrypted = 0;
+	int encryptStatus = EVP_EncryptUpdate(&ctx, payload, &bytesEncrypted, cleartextChunk, cleartextChunkLength);
+	EVP_CIPHER_CTX_cleanup(&ctx);
+	if (encryptStatus == 0 || bytesEncrypted != cleartextChunkLength) {
+		return NO;
 	}
 
-	// open cleartext output stream:
-	NSOutputStream *output = [NSOutputStream outputStreamToFileAtPath:outPath append:NO];
-	[output scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-	[output open];
+	// authenticate ciphertext chunk:
+	unsigned char *chunkMac = &ciphertextChunk[kSETOCryptorV5NonceLength + bytesEncrypted];
+	[self calculateMac:chunkMac forChunk:ciphertextChunk payloadLength:bytesEncrypted chunkNumber:chunkNumber headerNonce:headerNonce];
+	return YES;
+}
 
-	// decrypt content (ignoring chunk macs, assuming it's authentic):
+- (BOOL)decryptChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength fileKey:(const unsigned char *)fileKey cleartextChunk:(unsigned char *)cleartextChunk cleartextChunkLength:(int *)cleartextChunkLength {
+	if (ciphertextChunkLength < kSETOCryptorV5NonceLength + CC_SHA256_DIGEST_LENGTH) {
+		return NO;
+	}
+
+	// calculate payload length:
+	const unsigned char *nonce = &ciphertextChunk[0];
+	const unsigned char *payload = &ciphertextChunk[kSETOCryptorV5NonceLength];
+	int payloadLength = ciphertextChunkLength - kSETOCryptorV5NonceLength - CC_SHA256_DIGEST_LENGTH;
+
+	// decrypt chunk:
 	const EVP_CIPHER *ctrCipher = EVP_aes_256_ctr();
 	EVP_CIPHER_CTX ctx;
 	EVP_CIPHER_CTX_init(&ctx);
 	EVP_CIPHER_CTX_set_padding(&ctx, 0);
-	while (input.hasBytesAvailable) {
-		// read chunk:
-		int ciphertextChunkLength = kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH;
-		unsigned char ciphertextChunk[ciphertextChunkLength];
-		int inputLength = (int)[input read:ciphertextChunk maxLength:ciphertextChunkLength];
-		if (inputLength == 0) {
-			continue;
-		} else if (inputLength < kSETOCryptorV5NonceLength + CC_SHA256_DIGEST_LENGTH) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
-			return;
-		}
+	EVP_DecryptInit_ex(&ctx, ctrCipher, NULL, fileKey, nonce);
+	int decryptStatus = EVP_DecryptUpdate(&ctx, cleartextChunk, cleartextChunkLength, payload, payloadLength);
+	EVP_CIPHER_CTX_cleanup(&ctx);
+	return decryptStatus != 0 && *cleartextChunkLength == payloadLength;
+}
 
-		// init decryption:
-		unsigned char *nonce = &ciphertextChunk[0];
-		unsigned char *payload = &ciphertextChunk[kSETOCryptorV5NonceLength];
-		EVP_DecryptInit_ex(&ctx, ctrCipher, NULL, fileKey, nonce);
-
-		// calculate payload length:
-		int payloadLength = inputLength - kSETOCryptorV5NonceLength - CC_SHA256_DIGEST_LENGTH;
-
-		// decrypt chunk:
-		int cleartextChunkLength = payloadLength + kSETOCryptorV5BlockSize;
-		unsigned char cleartextChunk[cleartextChunkLength];
-		int outputLength = 0;
-		int decryptStatus = EVP_DecryptUpdate(&ctx, cleartextChunk, &outputLength, payload, payloadLength);
-		if (decryptStatus == 0) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
-			return;
-		}
+- (void)calculateMac:(unsigned char *)mac forChunk:(const unsigned char *)ciphertextChunk payloadLength:(int)payloadLength chunkNumber:(uint64_t)chunkNumber headerNonce:(const unsigned char *)headerNonce {
+	unsigned char chunkNumberBytes[sizeof(uint64_t)] = {0};
+	long_to_big_endian_bytes(chunkNumber, chunkNumberBytes);
+	CCHmacContext chunkHmacContext;
+	[self.masterKeyContext getHmacContext:&chunkHmacContext];
+	CCHmacUpdate(&chunkHmacContext, headerNonce, kSETOCryptorV5NonceLength);
+	CCHmacUpdate(&chunkHmacContext, chunkNumberBytes, sizeof(chunkNumberBytes));
+	CCHmacUpdate(&chunkHmacContext, ciphertextChunk, kSETOCryptorV5NonceLength + payloadLength); // nonce + payload
+	CCHmacFinal(&chunkHmacContext, mac);
+}
+
+- (BOOL)isAuthenticChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength chunkNumber:(uint64_t)chunkNumber headerNonce:(const unsigned char *)headerNonce {
+	if (ciphertextChunkLength < kSETOCryptorV5NonceLength + CC_SHA256_DIGEST_LENGTH) {
+		return NO;
+	}
+	int payloadLength = ciphertextChunkLength - kSETOCryptorV5NonceLength - CC_SHA256_DIGEST_LENGTH;
+	unsigned char calculatedMac[CC_SHA256_DIGEST_LENGTH];
+	[self calculateMac:calculatedMac forChunk:ciphertextChunk payloadLength:payloadLength chunkNumber:chunkNumber headerNonce:headerNonce];
+
+	// constant time comparison of chunk mac:
+	unsigned char *expectedMac = (unsigned char *)&ciphertextChunk[kSETOCryptorV5NonceLength + payloadLength];
+	return compare_bytes(calculatedMac, expectedMac, CC_SHA256_DIGEST_LENGTH);
+}
+
+- (BOOL)processChunk:(uint64_t)chunkNumber ofFile:(SETOFileHandle *)input atOffset:(uint64_t)inputOffset chunkLength:(int)inputChunkLength toFile:(SETOFileHandle *)output atOffset:(uint64_t)outputOffset chunkLength:(int)outputChunkLength inputBuffer:(unsigned char *)inputChunk outputBuffer:(unsigned char *)outputChunk transform:(SETOCryptorV5ChunkTransform)transform {
+	// read chunk:
+	NSInteger inputLength = [input readBytes:inputChunk length:inputChunkLength atOffset:inputOffset + chunkNumber * inputChunkLength];
+	if (inputLength <= 0) {
+		return NO;
+	}
 
-		// write cleartext chunk:
-		int bytesWritten = (int)[output write:cleartextChunk maxLength:outputLength];
-		if (bytesWritten != outputLength) {
-			[input close];
-			[output close];
-			EVP_CIPHER_CTX_cleanup(&ctx);
-			callback([NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorDecryptionFailedError userInfo:nil]);
-			return;
+	// process chunk:
+	int outputLength = 0;
+	if (!transform(inputChunk, (int)inputLength, chunkNumber, outputChunk, &outputLength)) {
+		return NO;
+	}
+
+	// write chunk:
+	return [output writeBytes:outputChunk length:outputLength atOffset:outputOffset + chunkNumber * outputChunkLength];
+}
+
+- (NSError *)processChunks:(uint64_t)chunkCount ofFile:(SETOFileHandle *)input atOffset:(uint64_t)inputOffset chunkLength:(int)inputChunkLength toFile:(SETOFileHandle *)output atOffset:(uint64_t)outputOffset chunkLength:(int)outputChunkLength errorCode:(SETOCryptorError)errorCode progress:(SETOCryptorProgressCallback)progressCallback transform:(SETOCryptorV5ChunkTransform)transform {
+	if (self.maxConcurrentChunkOperationCount > 1 && chunkCount > 1) {
+		return [self processChunksConcurrently:chunkCount ofFile:input atOffset:inputOffset chunkLength:inputChunkLength toFile:output atOffset:outputOffset chunkLength:outputChunkLength errorCode:errorCode progress:progressCallback transform:transform];
+	}
+	unsigned char inputChunk[inputChunkLength];
+	unsigned char outputChunk[outputChunkLength];
+	for (uint64_t chunkNumber = 0; chunkNumber < chunkCount; chunkNumber++) {
+		if (![self processChunk:chunkNumber ofFile:input atOffset:inputOffset chunkLength:inputChunkLength toFile:output atOffset:outputOffset chunkLength:outputChunkLength inputBuffer:inputChunk outputBuffer:outputChunk transform:transform]) {
+			return [NSError errorWithDomain:kSETOCryptorErrorDomain code:errorCode userInfo:nil];
 		}
 
 		// progress:
-		bytesProcessed += payloadLength;
 		if (progressCallback) {
-			progressCallback((CGFloat)bytesProcessed / fileSize);
+			progressCallback((CGFloat)(chunkNumber + 1) / chunkCount);
 		}
 	}
-	EVP_CIPHER_CTX_cleanup(&ctx);
+	return nil;
+}
 
-	// done:
-	[input close];
-	[output close];
-	if (progressCallback) {
-		progressCallback(1.0);
+- (NSError *)processChunksConcurrently:(uint64_t)chunkCount ofFile:(SETOFileHandle *)input atOffset:(uint64_t)inputOffset chunkLength:(int)inputChunkLength toFile:(SETOFileHandle *)output atOffset:(uint64_t)outputOffset chunkLength:(int)outputChunkLength errorCode:(SETOCryptorError)errorCode progress:(SETOCryptorProgressCallback)progressCallback transform:(SETOCryptorV5ChunkTransform)transform {
+	// chunk offsets are known upfront, so every worker reads, processes and writes its own chunks without any reordering:
+	NSUInteger workerCount = (NSUInteger)MIN(self.maxConcurrentChunkOperationCount, chunkCount);
+	dispatch_queue_t workerQueue = dispatch_get_global_queue(qos_class_self(), 0);
+	dispatch_semaphore_t chunkProcessed = dispatch_semaphore_create(0);
+	dispatch_group_t group = dispatch_group_create();
+	__block atomic_bool failed = false;
+	for (NSUInteger worker = 0; worker < workerCount; worker++) {
+		dispatch_group_async(group, workerQueue, ^{
+			NSMutableData *buffer = [NSMutableData dataWithLength:inputChunkLength + outputChunkLength];
+			unsigned char *inputChunk = buffer.mutableBytes;
+			unsigned char *outputChunk = inputChunk + inputChunkLength;
+			for (uint64_t chunkNumber = worker; chunkNumber < chunkCount; chunkNumber += workerCount) {
+				if (!atomic_load(&failed) && ![self processChunk:chunkNumber ofFile:input atOffset:inputOffset chunkLength:inputChunkLength toFile:output atOffset:outputOffset chunkLength:outputChunkLength inputBuffer:inputChunk outputBuffer:outputChunk transform:transform]) {
+					atomic_store(&failed, true);
+				}
+				dispatch_semaphore_signal(chunkProcessed);
+			}
+		});
 	}
-	callback(nil);
+
+	// progress is reported on the calling thread:
+	for (uint64_t chunksProcessed = 1; chunksProcessed <= chunkCount; chunksProcessed++) {
+		dispatch_semaphore_wait(chunkProcessed, DISPATCH_TIME_FOREVER);
+		if (progressCallback && !atomic_load(&failed)) {
+			progressCallback((CGFloat)chunksProcessed / chunkCount);
+		}
+	}
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+	return atomic_load(&failed) ? [NSError errorWithDomain:kSETOCryptorErrorDomain code:errorCode userInfo:nil] : nil;
 }
 
 #pragma mark - File Size Calculation
@@ -0,0 +1,29 @@
+//
+//  SETOCryptorV5_Private.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOCryptorV5.h"
+
+extern int const kSETOCryptorV5NonceLength;
+extern int const kSETOCryptorV5HeaderLength;
+extern int const kSETOCryptorV5HeaderPayloadLength;
+extern int const kSETOCryptorV5ChunkPayloadLength;
+
+/**
+ *  File header and chunk primitives of @c SETOCryptorV5, shared with the streaming encryptor and decryptor.
+ */
+@interface SETOCryptorV5 ()
+
+- (BOOL)createFileHeader:(unsigned char *)header fileKey:(unsigned char *)fileKey;
+- (BOOL)decryptFileHeader:(const unsigned char *)header fileKey:(unsigned char *)fileKey;
+- (BOOL)isAuthenticFileHeader:(const unsigned char *)header;
+
+- (BOOL)encryptChunk:(const unsigned char *)cleartextChunk length:(int)cleartextChunkLength chunkNumber:(uint64_t)chunkNumber headerNonce:(const unsigned char *)headerNonce fileKey:(const unsigned char *)fileKey ciphertextChunk:(unsigned char *)ciphertextChunk;
+- (BOOL)decryptChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength fileKey:(const unsigned char *)fileKey cleartextChunk:(unsigned char *)cleartextChunk cleartextChunkLength:(int *)cleartextChunkLength;
+- (BOOL)isAuthenticChunk:(const unsigned char *)ciphertextChunk length:(int)ciphertextChunkLength chunkNumber:(uint64_t)chunkNumber headerNonce:(const unsigned char *)headerNonce;
+
+@end
@@ -0,0 +1,18 @@
+//
+//  SETOFileContentDecryptorV5.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentDecryptor.h"
+#import "SETOCryptor.h"
+
+@class SETOCryptorV5;
+
+@interface SETOFileContentDecryptorV5 : SETOFileContentDecryptor
+
+- (instancetype)initWithCryptor:(SETOCryptorV5 *)cryptor source:(SETOCryptorReadCallback)source;
+
+@end
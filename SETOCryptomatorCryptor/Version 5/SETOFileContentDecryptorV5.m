@@ -0,0 +1,90 @@
+//
+//  SETOFileContentDecryptorV5.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentDecryptorV5.h"
+#import "SETOFileContentDecryptor_Private.h"
+#import "SETOCryptorV5_Private.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+@interface SETOFileContentDecryptorV5 ()
+@property (nonatomic, strong) SETOCryptorV5 *cryptor;
+@property (nonatomic, strong) NSMutableData *header;
+@property (nonatomic, strong) NSMutableData *ciphertextChunk;
+@property (nonatomic, assign) uint64_t chunkNumber;
+@property (nonatomic, assign) BOOL headerRead;
+@property (nonatomic, assign) BOOL atEnd;
+@end
+
+@implementation SETOFileContentDecryptorV5
+
+#pragma mark - Initialization
+
+- (instancetype)initWithCryptor:(SETOCryptorV5 *)cryptor source:(SETOCryptorReadCallback)source {
+	NSParameterAssert(cryptor);
+	if (self = [super initWithSource:source]) {
+		self.cryptor = cryptor;
+		self.header = [NSMutableData dataWithLength:kSETOCryptorV5HeaderLength];
+		self.ciphertextChunk = [NSMutableData dataWithLength:kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH];
+	}
+	return self;
+}
+
+#pragma mark - Streaming File Content Decryption
+
+- (NSData *)readChunkWithError:(NSError **)error {
+	if (self.failed) {
+		return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+	}
+	if (self.atEnd) {
+		return [NSData data];
+	}
+
+	// read, authenticate and decrypt file header on first use:
+	if (!self.headerRead) {
+		NSInteger headerLength = [self readBytes:self.header.mutableBytes length:self.header.length];
+		if (headerLength < 0) {
+			return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+		} else if (headerLength != kSETOCryptorV5HeaderLength) {
+			return [self failWithCode:SETOCryptorCorruptedFileHeaderError error:error];
+		} else if (![self.cryptor isAuthenticFileHeader:self.header.bytes]) {
+			return [self failWithCode:SETOCryptorAuthenticationFailedError error:error];
+		} else if (![self.cryptor decryptFileHeader:self.header.bytes fileKey:self.fileKey.mutableBytes]) {
+			return [self failWithCode:SETOCryptorCorruptedFileHeaderError error:error];
+		}
+		self.headerRead = YES;
+	}
+
+	// read chunk, a partial chunk is the last one:
+	NSInteger inputLength = [self readBytes:self.ciphertextChunk.mutableBytes length:self.ciphertextChunk.length];
+	if (inputLength < 0) {
+		return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+	} else if (inputLength == 0) {
+		self.atEnd = YES;
+		return [NSData data];
+	} else if (inputLength < self.ciphertextChunk.length) {
+		self.atEnd = YES;
+	}
+
+	// authenticate chunk:
+	if (![self.cryptor isAuthenticChunk:self.ciphertextChunk.bytes length:(int)inputLength chunkNumber:self.chunkNumber headerNonce:self.header.bytes]) {
+		return [self failWithCode:SETOCryptorAuthenticationFailedError error:error];
+	}
+
+	// decrypt chunk:
+	NSMutableData *cleartextChunk = [NSMutableData dataWithLength:kSETOCryptorV5ChunkPayloadLength];
+	int cleartextChunkLength = 0;
+	if (![self.cryptor decryptChunk:self.ciphertextChunk.bytes length:(int)inputLength fileKey:self.fileKey.bytes cleartextChunk:cleartextChunk.mutableBytes cleartextChunkLength:&cleartextChunkLength]) {
+		return [self failWithCode:SETOCryptorDecryptionFailedError error:error];
+	}
+	cleartextChunk.length = cleartextChunkLength;
+	self.chunkNumber++;
+	return cleartextChunk;
+}
+
+@end
@@ -0,0 +1,17 @@
+//
+//  SETOFileContentEncryptorV5.h
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentEncryptor.h"
+
+@class SETOCryptorV5;
+
+@interface SETOFileContentEncryptorV5 : SETOFileContentEncryptor
+
+- (instancetype)initWithCryptor:(SETOCryptorV5 *)cryptor error:(NSError **)error; // creates file header with random iv and random file key
+
+@end
@@ -0,0 +1,135 @@
+//
+//  SETOFileContentEncryptorV5.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import "SETOFileContentEncryptorV5.h"
+#import "SETOCryptorV5_Private.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+@interface SETOFileContentEncryptorV5 ()
+@property (nonatomic, strong) SETOCryptorV5 *cryptor;
+@property (nonatomic, strong) NSMutableData *header;
+@property (nonatomic, strong) NSMutableData *fileKey;
+@property (nonatomic, strong) NSMutableData *cleartextChunk;
+@property (nonatomic, assign) uint64_t chunkNumber;
+@property (nonatomic, assign) BOOL headerEmitted;
+@property (nonatomic, assign) BOOL finished;
+@end
+
+@implementation SETOFileContentEncryptorV5
+
+#pragma mark - Initialization
+
+- (instancetype)initWithCryptor:(SETOCryptorV5 *)cryptor error:(NSError **)error {
+	NSParameterAssert(cryptor);
+	if (self = [super init]) {
+		self.cryptor = cryptor;
+		self.header = [NSMutableData dataWithLength:kSETOCryptorV5HeaderLength];
+		self.fileKey = [NSMutableData dataWithLength:32];
+		self.cleartextChunk = [NSMutableData dataWithCapacity:kSETOCryptorV5ChunkPayloadLength];
+		if (![cryptor createFileHeader:self.header.mutableBytes fileKey:self.fileKey.mutableBytes]) {
+			if (error) {
+				*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+			}
+			return nil;
+		}
+	}
+	return self;
+}
+
+- (void)dealloc {
+	memset_s(self.fileKey.mutableBytes, self.fileKey.length, 0, self.fileKey.length);
+	memset_s(self.cleartextChunk.mutableBytes, self.cleartextChunk.length, 0, self.cleartextChunk.length);
+}
+
+#pragma mark - Streaming File Content Encryption
+
+- (NSData *)updateWithData:(NSData *)data error:(NSError **)error {
+	NSParameterAssert(data);
+	if (self.finished) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+		}
+		return nil;
+	}
+	NSUInteger completedChunkCount = (self.cleartextChunk.length + data.length) / kSETOCryptorV5ChunkPayloadLength;
+	NSMutableData *ciphertext = [NSMutableData dataWithCapacity:kSETOCryptorV5HeaderLength + completedChunkCount * (kSETOCryptorV5NonceLength + kSETOCryptorV5ChunkPayloadLength + CC_SHA256_DIGEST_LENGTH)];
+	[self appendHeaderIfNeededToCiphertext:ciphertext];
+
+	const unsigned char *bytes = data.bytes;
+	NSUInteger remaining = data.length;
+	while (remaining > 0) {
+		// full chunks are encrypted directly from input, only partial chunks are buffered:
+		if (self.cleartextChunk.length == 0 && remaining >= kSETOCryptorV5ChunkPayloadLength) {
+			if (![self appendChunk:bytes length:kSETOCryptorV5ChunkPayloadLength toCiphertext:ciphertext error:error]) {
+				return nil;
+			}
+			bytes += kSETOCryptorV5ChunkPayloadLength;
+			remaining -= kSETOCryptorV5ChunkPayloadLength;
+			continue;
+		}
+		NSUInteger length = MIN(remaining, kSETOCryptorV5ChunkPayloadLength - self.cleartextChunk.length);
+		[self.cleartextChunk appendBytes:bytes length:length];
+		bytes += length;
+		remaining -= length;
+		if (self.cleartextChunk.length == kSETOCryptorV5ChunkPayloadLength) {
+			if (![self appendChunk:self.cleartextChunk.bytes length:kSETOCryptorV5ChunkPayloadLength toCiphertext:ciphertext error:error]) {
+				return nil;
+			}
+			self.cleartextChunk.length = 0;
+		}
+	}
+	return ciphertext;
+}
+
+- (NSData *)finishWithError:(NSError **)error {
+	if (self.finished) {
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+		}
+		return nil;
+	}
+	NSMutableData *ciphertext = [NSMutableData data];
+	[self appendHeaderIfNeededToCiphertext:ciphertext];
+	if (self.cleartextChunk.length > 0) {
+		if (![self appendChunk:self.cleartextChunk.bytes length:(int)self.cleartextChunk.length toCiphertext:ciphertext error:error]) {
+			return nil;
+		}
+		memset_s(self.cleartextChunk.mutableBytes, self.cleartextChunk.length, 0, self.cleartextChunk.length);
+		self.cleartextChunk.length = 0;
+	}
+	self.finished = YES;
+	return ciphertext;
+}
+
+#pragma mark - Internal
+
+- (void)appendHeaderIfNeededToCiphertext:(NSMutableData *)ciphertext {
+	if (!self.headerEmitted) {
+		[ciphertext appendData:self.header];
+		self.headerEmitted = YES;
+	}
+}
+
+- (BOOL)appendChunk:(const unsigned char *)cleartextChunk length:(int)cleartextChunkLength toCiphertext:(NSMutableData *)ciphertext error:(NSError **)error {
+	NSUInteger offset = ciphertext.length;
+	[ciphertext increaseLengthBy:kSETOCryptorV5NonceLength + cleartextChunkLength + CC_SHA256_DIGEST_LENGTH];
+	unsigned char *ciphertextChunk = (unsigned char *)ciphertext.mutableBytes + offset;
+	if (![self.cryptor encryptChunk:cleartextChunk length:cleartextChunkLength chunkNumber:self.chunkNumber headerNonce:self.header.bytes fileKey:self.fileKey.bytes ciphertextChunk:ciphertextChunk]) {
+		// the stream is broken, since a chunk is missing:
+		self.finished = YES;
+		if (error) {
+			*error = [NSError errorWithDomain:kSETOCryptorErrorDomain code:SETOCryptorEncryptionFailedError userInfo:nil];
+		}
+		return NO;
+	}
+	self.chunkNumber++;
+	return YES;
+}
+
+@end
@@ -8,26 +8,44 @@
 
 #import "SETOCryptorV7.h"
 
-#import "NSData+SETOBase64urlEncoding.h"
+#import "SETOBaseEncodingUtil.h"
 
-NSString *const kSETOCryptorV7CiphertextFilenamePattern = @"^([a-zA-Z0-9-_]{4})*[a-zA-Z0-9-_]{20}[a-zA-Z0-9-_=]{4}$";
+NSString *const kSETOCryptorV7CiphertextFileExtension = @".c9r";
 
 @implementation SETOCryptorV7
 
 #pragma mark - Path Encoding and Decoding
 
-- (NSString *)encodeFilename:(NSData *)filename {
-	return [filename seto_base64urlEncodedString];
+- (NSUInteger)encodedLengthOfFilenameLength:(NSUInteger)length {
+	return seto_base64url_encoded_length(length);
 }
 
-- (NSData *)decodeFilename:(NSString *)filename {
-	return [NSData seto_dataWithBase64urlEncodedString:filename];
+- (NSUInteger)decodedMaxLengthOfFilenameLength:(NSUInteger)length {
+	return seto_base64url_decoded_max_length(length);
 }
 
-- (BOOL)isValidEncryptedFilename:(NSString *)filename {
-	NSRegularExpression *regex = [NSRegularExpression regularExpressionWithPattern:kSETOCryptorV7CiphertextFilenamePattern options:NSRegularExpressionCaseInsensitive error:NULL];
-	NSUInteger numberOfMatches = [regex numberOfMatchesInString:filename options:0 range:NSMakeRange(0, filename.length)];
-	return numberOfMatches > 0;
+- (NSUInteger)encodeFilename:(const unsigned char *)filename length:(NSUInteger)length buffer:(char *)buffer {
+	return seto_base64url_encode(filename, length, buffer);
+}
+
+- (BOOL)decodeFilename:(const char *)filename length:(NSUInteger)length buffer:(unsigned char *)buffer decodedLength:(NSUInteger *)decodedLength {
+	size_t outputLength = 0;
+	if (seto_base64url_decode(filename, length, buffer, &outputLength)) {
+		return NO;
+	}
+	*decodedLength = outputLength;
+	return YES;
+}
+
+#pragma mark - Path Resolution
+
+- (NSString *)ciphertextNodeNameForEncryptedFilename:(NSString *)encryptedFilename {
+	return [encryptedFilename stringByAppendingString:kSETOCryptorV7CiphertextFileExtension];
+}
+
+- (NSString *)ciphertextDirectoryNodeNameForEncryptedFilename:(NSString *)encryptedFilename {
+	// directory nodes are directories containing a dir.c9r file:
+	return [encryptedFilename stringByAppendingString:kSETOCryptorV7CiphertextFileExtension];
 }
 
 @end
@@ -98,6 +98,46 @@
 	XCTAssert(result != 0);
 }
 
+- (void)testSivContextReuseAndCopy {
+	const unsigned char macKey[16] = {0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, //
+	                                  0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0};
+
+	const unsigned char aesKey[16] = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, //
+	                                  0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+
+	const unsigned char ad1[24] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, //
+	                               0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, //
+	                               0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27};
+	const unsigned char *ads[1] = {ad1};
+	const size_t ad_sizes[1] = {24};
+
+	const unsigned char plaintext[14] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, //
+	                                     0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee};
+
+	const unsigned char expected[30] = {0x85, 0x63, 0x2d, 0x07, 0xc6, 0xe8, 0xf3, 0x7f, //
+	                                    0x95, 0x0a, 0xcd, 0x32, 0x0a, 0x2e, 0xcc, 0x93, //
+	                                    0x40, 0xc0, 0x2b, 0x96, 0x90, 0xc4, 0xdc, 0x04, //
+	                                    0xda, 0xef, 0x7f, 0x6a, 0xfe, 0x5c};
+	NSData *expectedData = [NSData dataWithBytes:expected length:30];
+	NSData *plaintextData = [NSData dataWithBytes:plaintext length:14];
+
+	siv_ctx *ctx = siv_ctx_new(aesKey, macKey, 16);
+	XCTAssert(ctx != NULL);
+	siv_ctx *copy = siv_ctx_copy(ctx);
+	XCTAssert(copy != NULL);
+	for (int i = 0; i < 3; i++) {
+		unsigned char out[30];
+		XCTAssert(siv_enc_ctx(i % 2 ? ctx : copy, plaintext, 14, 1, ads, ad_sizes, out) == 0);
+		XCTAssertEqualObjects(expectedData, [NSData dataWithBytes:out length:30]);
+
+		unsigned char decrypted[14];
+		XCTAssert(siv_dec_ctx(i % 2 ? copy : ctx, out, 30, 1, ads, ad_sizes, decrypted) == 0);
+		XCTAssertEqualObjects(plaintextData, [NSData dataWithBytes:decrypted length:14]);
+	}
+	siv_ctx_free(copy);
+	siv_ctx_free(ctx);
+}
+
 - (void)testS2V {
 	const unsigned char macKey[16] = {0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, //
 	                                  0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0};
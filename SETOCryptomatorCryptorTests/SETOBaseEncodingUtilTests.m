@@ -0,0 +1,102 @@
+//
+//  SETOBaseEncodingUtilTests.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SETOBaseEncodingUtil.h"
+#import "NSData+SETOBase32Encoding.h"
+#import "NSData+SETOBase64urlEncoding.h"
+
+@interface SETOBaseEncodingUtilTests : XCTestCase
+@end
+
+/**
+ * Tests from https://tools.ietf.org/html/rfc4648#section-10
+ */
+@implementation SETOBaseEncodingUtilTests
+
+- (void)testBase64urlEncode {
+	NSArray *inputs = @[@"", @"f", @"fo", @"foo", @"foob", @"fooba", @"foobar"];
+	NSArray *expected = @[@"", @"Zg==", @"Zm8=", @"Zm9v", @"Zm9vYg==", @"Zm9vYmE=", @"Zm9vYmFy"];
+	for (NSUInteger i = 0; i < inputs.count; i++) {
+		NSData *input = [inputs[i] dataUsingEncoding:NSASCIIStringEncoding];
+		char out[8];
+		size_t outLen = seto_base64url_encode(input.bytes, input.length, out);
+		XCTAssertEqual(outLen, seto_base64url_encoded_length(input.length));
+		XCTAssertEqualObjects([[NSString alloc] initWithBytes:out length:outLen encoding:NSASCIIStringEncoding], expected[i]);
+	}
+}
+
+- (void)testBase32Encode {
+	NSArray *inputs = @[@"", @"f", @"fo", @"foo", @"foob", @"fooba", @"foobar"];
+	NSArray *expected = @[@"", @"MY======", @"MZXQ====", @"MZXW6===", @"MZXW6YQ=", @"MZXW6YTB", @"MZXW6YTBOI======"];
+	for (NSUInteger i = 0; i < inputs.count; i++) {
+		NSData *input = [inputs[i] dataUsingEncoding:NSASCIIStringEncoding];
+		char out[16];
+		size_t outLen = seto_base32_encode(input.bytes, input.length, out);
+		XCTAssertEqual(outLen, seto_base32_encoded_length(input.length));
+		XCTAssertEqualObjects([[NSString alloc] initWithBytes:out length:outLen encoding:NSASCIIStringEncoding], expected[i]);
+	}
+}
+
+- (void)testRoundTrip {
+	// lengths beyond 16 characters are processed by the vectorized code paths:
+	for (NSUInteger length = 0; length < 1024; length++) {
+		NSMutableData *data = [NSMutableData dataWithLength:length];
+		arc4random_buf(data.mutableBytes, length);
+
+		NSMutableData *base64url = [NSMutableData dataWithLength:seto_base64url_encoded_length(length)];
+		size_t base64urlLen = seto_base64url_encode(data.bytes, length, base64url.mutableBytes);
+		NSMutableData *decoded = [NSMutableData dataWithLength:seto_base64url_decoded_max_length(base64urlLen)];
+		size_t decodedLen;
+		XCTAssertEqual(seto_base64url_decode(base64url.bytes, base64urlLen, decoded.mutableBytes, &decodedLen), 0);
+		decoded.length = decodedLen;
+		XCTAssertEqualObjects(decoded, data);
+
+		NSMutableData *base32 = [NSMutableData dataWithLength:seto_base32_encoded_length(length)];
+		size_t base32Len = seto_base32_encode(data.bytes, length, base32.mutableBytes);
+		decoded = [NSMutableData dataWithLength:seto_base32_decoded_max_length(base32Len)];
+		XCTAssertEqual(seto_base32_decode(base32.bytes, base32Len, decoded.mutableBytes, &decodedLen), 0);
+		decoded.length = decodedLen;
+		XCTAssertEqualObjects(decoded, data);
+	}
+}
+
+- (void)testDecodeLowercaseBase32 {
+	unsigned char out[10];
+	size_t outLen;
+	XCTAssertEqual(seto_base32_decode("mzxw6ytboi======", 16, out, &outLen), 0);
+	XCTAssertEqualObjects([NSData dataWithBytes:out length:outLen], [@"foobar" dataUsingEncoding:NSASCIIStringEncoding]);
+}
+
+- (void)testDecodeEmptyInput {
+	unsigned char out[1];
+	size_t outLen = 1;
+	XCTAssertEqual(seto_base64url_decode("", 0, out, &outLen), 0);
+	XCTAssertEqual(outLen, 0);
+	outLen = 1;
+	XCTAssertEqual(seto_base32_decode("", 0, out, &outLen), 0);
+	XCTAssertEqual(outLen, 0);
+	XCTAssertEqualObjects([NSData seto_dataWithBase64urlEncodedString:@""], [NSData data]);
+	XCTAssertEqualObjects([NSData seto_dataWithBase32EncodedString:@""], [NSData data]);
+}
+
+- (void)testDecodeInvalidInput {
+	unsigned char out[64];
+	size_t outLen;
+	XCTAssertEqual(seto_base64url_decode("Zm9vYmF", 7, out, &outLen), -1);
+	XCTAssertEqual(seto_base64url_decode("Zm9v====", 8, out, &outLen), -1);
+	XCTAssertEqual(seto_base64url_decode("Zm9vYmFy+m9vYmFyZm9vYmFy", 24, out, &outLen), -1);
+	XCTAssertEqual(seto_base64url_decode("Zm9vYmFyZm9vYmFyZm9v/mFy", 24, out, &outLen), -1);
+	XCTAssertEqual(seto_base32_decode(".DS_Stor", 8, out, &outLen), -1);
+	XCTAssertEqual(seto_base32_decode("MZXW6YTBOI=====", 15, out, &outLen), -1);
+	XCTAssertEqual(seto_base32_decode("MZXW6Y==", 8, out, &outLen), -1);
+	XCTAssertEqual(seto_base32_decode("MZXW61TBMZXW6YTBMZXW6YTB", 24, out, &outLen), -1);
+	XCTAssertEqual(seto_base32_decode("MZXW6YTBMZXW6YTBMZXW6Y\xc3\x9c", 24, out, &outLen), -1);
+}
+
+@end
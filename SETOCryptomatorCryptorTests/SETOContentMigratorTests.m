@@ -0,0 +1,106 @@
+//
+//  SETOContentMigratorTests.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SETOContentMigrator.h"
+#import "SETOCryptorV3.h"
+#import "SETOCryptorV7.h"
+#import "SETOMasterKey.h"
+#import "SETOMasterKeyFile.h"
+
+@interface SETOContentMigratorTests : XCTestCase
+@property (nonatomic, strong) SETOCryptor *sourceCryptor;
+@property (nonatomic, strong) SETOCryptor *targetCryptor;
+@property (nonatomic, strong) SETOContentMigrator *migrator;
+@end
+
+@implementation SETOContentMigratorTests
+
+- (void)setUp {
+	[super setUp];
+	NSString *masterKeyFileContentsStr = @"{\"version\":3,\"scryptSalt\":\"3cKOp+YKt64=\",\"scryptCostParam\":16384,\"scryptBlockSize\":8,\"primaryMasterKey\":\"yAIFYioq0cac6mHDBczjfbjuhSfeEIHFtGpcoR7fQ6h/LlQERnQXzQ==\",\"hmacMasterKey\":\"eSBguTyeLjddkIlyy1gp5zLagKiUUUjxaxUGaX1IeDu1SWEpAPymqQ==\"}";
+	NSData *masterKeyFileContents = [masterKeyFileContentsStr dataUsingEncoding:NSUTF8StringEncoding];
+
+	SETOMasterKeyFile *masterKeyFile = [[SETOMasterKeyFile alloc] initWithContentFromJSONData:masterKeyFileContents];
+	XCTAssertNotNil(masterKeyFile);
+
+	NSError *error;
+	SETOMasterKey *masterKey = [masterKeyFile unlockWithPassphrase:@"asd" pepper:nil error:&error];
+	XCTAssertNotNil(masterKey);
+	XCTAssertNil(error);
+
+	self.sourceCryptor = [[SETOCryptorV3 alloc] initWithMasterKey:masterKey];
+	self.targetCryptor = [[SETOCryptorV7 alloc] initWithMasterKey:masterKey];
+	self.migrator = [[SETOContentMigrator alloc] initWithSourceCryptor:self.sourceCryptor targetCryptor:self.targetCryptor];
+}
+
+- (void)testMigration {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v3" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSString *smallCiphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-source.aes"];
+	NSString *encryptedFileString = @"8lEJGixRMS3QxPS7+Lfx/n+gu1mbE+zYl4uhyqdmW9V6z7oT72epELVf/KEArykxqTnTxeVs6dl3fsmrrKIqyA4220SEl8bAmQuvZvFInL/gcSw8IvJctgprIZD4zcs+7J4zlvMmQ9Ye9/aa/ch4Bfzb13BnZyM8FKt9SgUMTLcR5CxDDRsu8VhuF5AwVwg1IoGMHA==";
+	[[[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0] writeToFile:smallCiphertextPath atomically:YES];
+	NSArray *targetPaths = @[[NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-target1.c9r"], [NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-target2.c9r"]];
+
+	// migrate:
+	__block NSError *migrationError;
+	__block CGFloat lastProgress = 0.0;
+	[self.migrator migrateFilesAtPaths:@[largeCiphertextPath, smallCiphertextPath] toPaths:targetPaths callback:^(NSError *error) {
+		migrationError = error;
+	} progress:^(CGFloat progress) {
+		lastProgress = progress;
+	}];
+	XCTAssertNil(migrationError);
+	XCTAssertEqual(lastProgress, 1.0);
+
+	// padding is dropped:
+	NSUInteger largeCleartextSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:largeCleartextPath error:NULL] fileSize];
+	NSUInteger largeTargetSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:targetPaths[0] error:NULL] fileSize];
+	XCTAssertEqual(largeTargetSize, [self.targetCryptor ciphertextSizeFromCleartextSize:largeCleartextSize]);
+
+	// decrypt with target cryptor:
+	NSString *decryptedPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-cleartext"];
+	XCTestExpectation *largeDecryptionFinished = [self expectationWithDescription:@"decryption of large file finished"];
+	[self.targetCryptor decryptFileAtPath:targetPaths[0] toPath:decryptedPath callback:^(NSError *error) {
+		XCTAssertNil(error);
+		XCTAssertTrue([[NSFileManager defaultManager] contentsEqualAtPath:decryptedPath andPath:largeCleartextPath]);
+		[largeDecryptionFinished fulfill];
+	} progress:nil];
+	[self waitForExpectationsWithTimeout:1.0 handler:nil];
+	XCTestExpectation *smallDecryptionFinished = [self expectationWithDescription:@"decryption of small file finished"];
+	[self.targetCryptor decryptFileAtPath:targetPaths[1] toPath:decryptedPath callback:^(NSError *error) {
+		XCTAssertNil(error);
+		XCTAssertEqualObjects([NSData dataWithContentsOfFile:decryptedPath], [@"setoLabs ftw" dataUsingEncoding:NSUTF8StringEncoding]);
+		[smallDecryptionFinished fulfill];
+	} progress:nil];
+	[self waitForExpectationsWithTimeout:1.0 handler:nil];
+
+	[[NSFileManager defaultManager] removeItemAtPath:smallCiphertextPath error:NULL];
+	[[NSFileManager defaultManager] removeItemAtPath:decryptedPath error:NULL];
+	for (NSString *targetPath in targetPaths) {
+		[[NSFileManager defaultManager] removeItemAtPath:targetPath error:NULL];
+	}
+}
+
+- (void)testMigrationOfUnauthenticFile {
+	NSString *sourcePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-source.aes"];
+	NSString *targetPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-target.c9r"];
+	NSString *encryptedFileString = @"8lEJGixRMS3QxPS7+Lfx/n+gu1mbE+zYl4uhyqdmW9V6z7oT72epELVf/KEArykxqTnTxeVs6dl3fsmrrKIqyA4220SEl8bAmQuvZvFInL/gcSw8IvJctgprIZD4zcs+7J4zlvMmQ9Ye9/aa/ch4Bfzb13BnZyM8FKt9SgUMTLcR5CxDDRsu8VhuF5AwVwg1IoGMHa==";
+	[[[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0] writeToFile:sourcePath atomically:YES];
+
+	__block NSError *migrationError;
+	[self.migrator migrateFilesAtPaths:@[sourcePath] toPaths:@[targetPath] callback:^(NSError *error) {
+		migrationError = error;
+	} progress:nil];
+	XCTAssertEqual(migrationError.code, SETOCryptorAuthenticationFailedError);
+	XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:targetPath]);
+
+	[[NSFileManager defaultManager] removeItemAtPath:sourcePath error:NULL];
+}
+
+@end
@@ -0,0 +1,185 @@
+//
+//  SETOCryptorBenchmarkTests.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SETOCryptorV3.h"
+#import "SETOCryptorV5.h"
+#import "SETOCryptorV7.h"
+#import "SETOMasterKey.h"
+
+/**
+ *  Measures throughput and latency of file content operations. Skipped unless the environment variable @c SETO_BENCHMARK is set, since it takes minutes.
+ *
+ *  Environment variables:
+ *  - @c SETO_BENCHMARK: Enables the benchmark.
+ *  - @c SETO_BENCHMARK_SIZES: Comma-separated file sizes in bytes. Defaults to 0 B, 1 KiB, 1 MiB and 64 MiB.
+ *  - @c SETO_BENCHMARK_LARGE: Adds 1 GiB and 4 GiB to the default file sizes.
+ *  - @c SETO_BENCHMARK_OUTPUT: Path of the JSON results. Defaults to @c SETOCryptorBenchmark.json in the temporary directory.
+ */
+@interface SETOCryptorBenchmarkTests : XCTestCase
+@end
+
+@implementation SETOCryptorBenchmarkTests
+
+- (void)testFileContentThroughput {
+	NSDictionary<NSString *, NSString *> *environment = [NSProcessInfo processInfo].environment;
+	if (!environment[@"SETO_BENCHMARK"]) {
+		NSLog(@"Skipping benchmark, set SETO_BENCHMARK to run it.");
+		return;
+	}
+
+	// configuration:
+	NSArray<NSNumber *> *fileSizes = [self fileSizesFromEnvironment:environment];
+	NSArray<NSNumber *> *threadCounts = [self threadCounts];
+	NSDictionary<NSString *, SETOCryptor *> *cryptors = [self cryptors];
+	NSString *cleartextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"benchmark.cleartext"];
+	NSString *ciphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"benchmark.ciphertext"];
+	NSString *decryptedPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"benchmark.decrypted"];
+
+	// measure every combination:
+	NSMutableArray<NSDictionary *> *results = [NSMutableArray array];
+	for (NSNumber *fileSize in fileSizes) {
+		XCTAssertTrue([self writeRandomFileAtPath:cleartextPath size:fileSize.unsignedLongLongValue]);
+		for (NSString *version in [cryptors.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+			SETOCryptor *cryptor = cryptors[version];
+			// version 3 has no parallel mode:
+			NSArray<NSNumber *> *versionThreadCounts = [cryptor isKindOfClass:[SETOCryptorV5 class]] ? threadCounts : @[@1];
+			for (NSNumber *threadCount in versionThreadCounts) {
+				cryptor.maxConcurrentChunkOperationCount = threadCount.unsignedIntegerValue;
+				NSDictionary<NSString *, void (^)(void)> *operations = @{
+					@"encrypt": ^{
+						[cryptor encryptFileAtPath:cleartextPath toPath:ciphertextPath callback:^(NSError *error) {
+							XCTAssertNil(error);
+						} progress:nil];
+					},
+					@"decrypt": ^{
+						[cryptor decryptFileAtPath:ciphertextPath toPath:decryptedPath callback:^(NSError *error) {
+							XCTAssertNil(error);
+						} progress:nil];
+					},
+					@"authenticate": ^{
+						[cryptor authenticateFileAtPath:ciphertextPath callback:^(NSError *error) {
+							XCTAssertNil(error);
+						} progress:nil];
+					}
+				};
+				// encrypt first, so that there is ciphertext to decrypt and authenticate:
+				for (NSString *operation in @[@"encrypt", @"decrypt", @"authenticate"]) {
+					NSArray<NSNumber *> *latencies = [self latenciesOfBlock:operations[operation] fileSize:fileSize.unsignedLongLongValue];
+					NSDictionary *result = [self resultWithVersion:version operation:operation fileSize:fileSize.unsignedLongLongValue threadCount:threadCount.unsignedIntegerValue latencies:latencies];
+					NSLog(@"%@ %@ %@ bytes, %@ threads: %.2f MB/s, %.6f s median", version, operation, fileSize, threadCount, [result[@"throughputMBps"] doubleValue], [result[@"medianLatencySeconds"] doubleValue]);
+					[results addObject:result];
+				}
+			}
+		}
+	}
+	[[NSFileManager defaultManager] removeItemAtPath:cleartextPath error:NULL];
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+	[[NSFileManager defaultManager] removeItemAtPath:decryptedPath error:NULL];
+
+	// write machine-readable results:
+	NSString *outputPath = environment[@"SETO_BENCHMARK_OUTPUT"] ?: [NSTemporaryDirectory() stringByAppendingPathComponent:@"SETOCryptorBenchmark.json"];
+	NSDictionary *report = @{
+		@"timestamp": @([NSDate date].timeIntervalSince1970),
+		@"operatingSystem": [NSProcessInfo processInfo].operatingSystemVersionString,
+		@"activeProcessorCount": @([NSProcessInfo processInfo].activeProcessorCount),
+		@"results": results
+	};
+	NSError *error;
+	NSData *json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:&error];
+	XCTAssertNotNil(json);
+	XCTAssertTrue([json writeToFile:outputPath options:NSDataWritingAtomic error:&error]);
+	NSLog(@"Benchmark results written to %@", outputPath);
+}
+
+#pragma mark - Configuration
+
+- (NSArray<NSNumber *> *)fileSizesFromEnvironment:(NSDictionary<NSString *, NSString *> *)environment {
+	if (environment[@"SETO_BENCHMARK_SIZES"]) {
+		NSMutableArray<NSNumber *> *fileSizes = [NSMutableArray array];
+		for (NSString *fileSize in [environment[@"SETO_BENCHMARK_SIZES"] componentsSeparatedByString:@","]) {
+			[fileSizes addObject:@(strtoull(fileSize.UTF8String, NULL, 10))];
+		}
+		return fileSizes;
+	}
+	NSMutableArray<NSNumber *> *fileSizes = [@[@0, @(1024), @(1024 * 1024), @(64 * 1024 * 1024)] mutableCopy];
+	if (environment[@"SETO_BENCHMARK_LARGE"]) {
+		[fileSizes addObjectsFromArray:@[@(1024ULL * 1024 * 1024), @(4ULL * 1024 * 1024 * 1024)]];
+	}
+	return fileSizes;
+}
+
+- (NSArray<NSNumber *> *)threadCounts {
+	NSUInteger processorCount = [NSProcessInfo processInfo].activeProcessorCount;
+	NSMutableOrderedSet<NSNumber *> *threadCounts = [NSMutableOrderedSet orderedSetWithArray:@[@1, @2, @4]];
+	[threadCounts addObject:@(processorCount)];
+	return threadCounts.array;
+}
+
+- (NSDictionary<NSString *, SETOCryptor *> *)cryptors {
+	NSMutableData *aesMasterKey = [NSMutableData dataWithLength:32];
+	NSMutableData *macMasterKey = [NSMutableData dataWithLength:32];
+	arc4random_buf(aesMasterKey.mutableBytes, aesMasterKey.length);
+	arc4random_buf(macMasterKey.mutableBytes, macMasterKey.length);
+	SETOMasterKey *masterKey = [[SETOMasterKey alloc] initWithAESMasterKey:aesMasterKey macMasterkey:macMasterKey];
+	return @{
+		@"v3": [[SETOCryptorV3 alloc] initWithMasterKey:masterKey],
+		@"v5": [[SETOCryptorV5 alloc] initWithMasterKey:masterKey],
+		@"v7": [[SETOCryptorV7 alloc] initWithMasterKey:masterKey]
+	};
+}
+
+#pragma mark - Measurement
+
+- (BOOL)writeRandomFileAtPath:(NSString *)path size:(unsigned long long)size {
+	if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil]) {
+		return NO;
+	}
+	NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+	NSMutableData *block = [NSMutableData dataWithLength:1024 * 1024];
+	for (unsigned long long written = 0; written < size; written += block.length) {
+		block.length = (NSUInteger)MIN(size - written, 1024 * 1024);
+		arc4random_buf(block.mutableBytes, block.length);
+		[fileHandle writeData:block];
+	}
+	[fileHandle closeFile];
+	return YES;
+}
+
+- (NSArray<NSNumber *> *)latenciesOfBlock:(void (^)(void))block fileSize:(unsigned long long)fileSize {
+	// repeat small files to get stable numbers, run large files once:
+	NSUInteger iterations = fileSize <= 1024 * 1024 ? 20 : (fileSize <= 64 * 1024 * 1024 ? 3 : 1);
+	NSMutableArray<NSNumber *> *latencies = [NSMutableArray arrayWithCapacity:iterations];
+	for (NSUInteger i = 0; i < iterations; i++) {
+		@autoreleasepool {
+			CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+			block();
+			[latencies addObject:@(CFAbsoluteTimeGetCurrent() - start)];
+		}
+	}
+	return latencies;
+}
+
+- (NSDictionary *)resultWithVersion:(NSString *)version operation:(NSString *)operation fileSize:(unsigned long long)fileSize threadCount:(NSUInteger)threadCount latencies:(NSArray<NSNumber *> *)latencies {
+	NSArray<NSNumber *> *sortedLatencies = [latencies sortedArrayUsingSelector:@selector(compare:)];
+	double medianLatency = sortedLatencies[sortedLatencies.count / 2].doubleValue;
+	double throughput = medianLatency > 0.0 ? fileSize / medianLatency / (1024.0 * 1024.0) : 0.0;
+	return @{
+		@"version": version,
+		@"operation": operation,
+		@"fileSize": @(fileSize),
+		@"threadCount": @(threadCount),
+		@"iterations": @(latencies.count),
+		@"medianLatencySeconds": @(medianLatency),
+		@"minLatencySeconds": sortedLatencies.firstObject,
+		@"maxLatencySeconds": sortedLatencies.lastObject,
+		@"throughputMBps": @(throughput)
+	};
+}
+
+@end
@@ -8,6 +8,7 @@
 
 #import <XCTest/XCTest.h>
 #import "SETOCryptorV3.h"
+#import "SETOFileContentDecryptor.h"
 #import "SETOMasterKey.h"
 #import "SETOMasterKeyFile.h"
 
@@ -98,6 +99,26 @@
 	XCTAssertTrue([@"HH7I6B3ME5N3ZOHUCLIAGQID5NFYNXGH" isEqualToString:encryptedPath]);
 }
 
+- (void)testCachedDirectoryIdEncryption {
+	NSString *directoryId = @"d77c2569-0b0b-41c1-9d6b-a3fb11933226";
+	NSString *encryptedDirectoryId = [self.cryptor encryptDirectoryId:directoryId];
+	XCTAssertEqualObjects([self.cryptor encryptDirectoryId:directoryId], encryptedDirectoryId);
+	XCTAssertEqual(self.cryptor.directoryIdCacheHitCount, 1);
+	XCTAssertEqual(self.cryptor.directoryIdCacheMissCount, 1);
+
+	// invalidated cache computes the same result:
+	[self.cryptor invalidateDirectoryIdCache];
+	XCTAssertEqualObjects([self.cryptor encryptDirectoryId:directoryId], encryptedDirectoryId);
+	XCTAssertEqual(self.cryptor.directoryIdCacheHitCount, 1);
+	XCTAssertEqual(self.cryptor.directoryIdCacheMissCount, 2);
+
+	// disabled cache:
+	self.cryptor.directoryIdCacheCapacity = 0;
+	XCTAssertEqualObjects([self.cryptor encryptDirectoryId:directoryId], encryptedDirectoryId);
+	XCTAssertEqual(self.cryptor.directoryIdCacheHitCount, 1);
+	XCTAssertEqual(self.cryptor.directoryIdCacheMissCount, 3);
+}
+
 #pragma mark - Decryption
 
 - (void)testDecryption {
@@ -149,6 +170,44 @@
 	[self waitForExpectationsWithTimeout:1.0 handler:nil];
 }
 
+- (void)testStreamingDecryption {
+	NSString *encryptedFileString = @"8lEJGixRMS3QxPS7+Lfx/n+gu1mbE+zYl4uhyqdmW9V6z7oT72epELVf/KEArykxqTnTxeVs6dl3fsmrrKIqyA4220SEl8bAmQuvZvFInL/gcSw8IvJctgprIZD4zcs+7J4zlvMmQ9Ye9/aa/ch4Bfzb13BnZyM8FKt9SgUMTLcR5CxDDRsu8VhuF5AwVwg1IoGMHA==";
+	NSData *encryptedFileData = [[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0];
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithInputStream:[NSInputStream inputStreamWithData:encryptedFileData] error:&error];
+	XCTAssertNotNil(decryptor);
+	XCTAssertNil(error);
+	NSData *chunk = [decryptor readChunkWithError:&error];
+	XCTAssertEqualObjects([[NSString alloc] initWithData:chunk encoding:NSUTF8StringEncoding], @"setoLabs ftw");
+	XCTAssertEqualObjects([decryptor readChunkWithError:&error], [NSData data]);
+	XCTAssertNil(error);
+}
+
+- (void)testStreamingDecryptionOfLargeFile {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v3" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithInputStream:[NSInputStream inputStreamWithFileAtPath:largeCiphertextPath] error:&error];
+	XCTAssertNotNil(decryptor);
+	NSMutableData *decrypted = [NSMutableData data];
+	NSData *chunk;
+	while ((chunk = [decryptor readChunkWithError:&error]).length > 0) {
+		[decrypted appendData:chunk];
+	}
+	XCTAssertNotNil(chunk);
+	XCTAssertNil(error);
+	XCTAssertEqualObjects(decrypted, [NSData dataWithContentsOfFile:largeCleartextPath]);
+}
+
+- (void)testStreamingDecryptionOfUnauthenticContent {
+	NSString *encryptedFileString = @"8lEJGixRMS3QxPS7+Lfx/n+gu1mbE+zYl4uhyqdmW9V6z7oT72epELVf/KEArykxqTnTxeVs6dl3fsmrrKIqyA4220SEl8bAmQuvZvFInL/gcSw8IvJctgprIZD4zcs+7J4zlvMmQ9Ye9/aa/ch4Bfzb13BnZyM8FKt9SgUMTLcR5CxDDRsu8VhuF5AwVwg1IoGMHa==";
+	NSData *encryptedFileData = [[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0];
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithInputStream:[NSInputStream inputStreamWithData:encryptedFileData] error:&error];
+	XCTAssertNil([decryptor readChunkWithError:&error]);
+	XCTAssertEqual(error.code, SETOCryptorAuthenticationFailedError);
+}
+
 - (void)testFancyUnicodeFoldernameDecryption {
 	NSString *ciphertext = @"YRDHTXQIW5VLBRHCBKDJJUQ5RQ3ZQY524DT3FYG6NVFSEYMYXMURYF2OMFSVQDAWNEML5XD7TMXYETWVSACXIQZF637LAJP7Q2NJU6Q=";
 	NSString *decrypted = [self.cryptor decryptFilename:ciphertext insideDirectoryWithId:@"63fb3905-9de6-4e0d-9cde-c6494cd6e0ad"];
@@ -161,6 +220,43 @@
 	XCTAssertNil(decrypted);
 }
 
+- (void)testMalformedFilenameDecryption {
+	NSString *directoryId = @"63fb3905-9de6-4e0d-9cde-c6494cd6e0ad";
+	NSString *ciphertext = @"YRDHTXQIW5VLBRHCBKDJJUQ5RQ3ZQY524DT3FYG6NVFSEYMYXMURYF2OMFSVQDAWNEML5XD7TMXYETWVSACXIQZF637LAJP7Q2NJU6Q=";
+	XCTAssertEqualObjects([self.cryptor decryptFilename:ciphertext.lowercaseString insideDirectoryWithId:directoryId], @"So oder so ähnlich könnte Ihr Ordner heißen");
+	XCTAssertNil([self.cryptor decryptFilename:@".DS_Store" insideDirectoryWithId:directoryId]);
+	XCTAssertNil([self.cryptor decryptFilename:@"AAAAAAAA" insideDirectoryWithId:directoryId]);
+	XCTAssertNil([self.cryptor decryptFilename:[ciphertext stringByReplacingOccurrencesOfString:@"Q=" withString:@"=="] insideDirectoryWithId:directoryId]);
+	XCTAssertNil([self.cryptor decryptFilename:[ciphertext stringByReplacingOccurrencesOfString:@"Y" withString:@"1"] insideDirectoryWithId:directoryId]);
+	XCTAssertNil([self.cryptor decryptFilename:[ciphertext stringByReplacingOccurrencesOfString:@"Y" withString:@"Ÿ"] insideDirectoryWithId:directoryId]);
+}
+
+- (void)testBatchFilenameDecryption {
+	NSString *directoryId = @"63fb3905-9de6-4e0d-9cde-c6494cd6e0ad";
+	NSMutableDictionary *expected = [NSMutableDictionary dictionary];
+	for (NSUInteger i = 0; i < 1000; i++) {
+		NSString *cleartext = [NSString stringWithFormat:@"Datei %tu.txt", i];
+		expected[[self.cryptor encryptFilename:cleartext insideDirectoryWithId:directoryId]] = cleartext;
+	}
+	NSString *foreignCiphertext = [self.cryptor encryptFilename:@"Andere Datei.txt" insideDirectoryWithId:@"other"];
+	NSArray *filenames = [expected.allKeys arrayByAddingObjectsFromArray:@[@"Test", foreignCiphertext]];
+	NSDictionary *decrypted = [self.cryptor decryptFilenames:filenames insideDirectoryWithId:directoryId];
+	XCTAssertEqualObjects(decrypted, expected);
+}
+
+- (void)testUTF8StringFilenameDecryption {
+	const char *directoryId = "63fb3905-9de6-4e0d-9cde-c6494cd6e0ad";
+	const char *ciphertext = "YRDHTXQIW5VLBRHCBKDJJUQ5RQ3ZQY524DT3FYG6NVFSEYMYXMURYF2OMFSVQDAWNEML5XD7TMXYETWVSACXIQZF637LAJP7Q2NJU6Q=";
+	const char *cleartext = "So oder so ähnlich könnte Ihr Ordner heißen";
+	char buffer[strlen(ciphertext)];
+	NSInteger length = [self.cryptor decryptFilenameUTF8String:ciphertext length:strlen(ciphertext) insideDirectoryWithIdUTF8String:directoryId length:strlen(directoryId) buffer:buffer maxLength:sizeof(buffer)];
+	XCTAssertEqual(length, (NSInteger)strlen(cleartext));
+	XCTAssertEqual(memcmp(buffer, cleartext, strlen(cleartext)), 0);
+	XCTAssertEqual([self.cryptor decryptFilenameUTF8String:ciphertext length:strlen(ciphertext) insideDirectoryWithIdUTF8String:directoryId length:strlen(directoryId) buffer:buffer maxLength:strlen(cleartext)], -1);
+	XCTAssertEqual([self.cryptor decryptFilenameUTF8String:ciphertext length:strlen(ciphertext) insideDirectoryWithIdUTF8String:"" length:0 buffer:buffer maxLength:sizeof(buffer)], -1);
+	XCTAssertEqual([self.cryptor decryptFilenameUTF8String:"Test" length:4 insideDirectoryWithIdUTF8String:directoryId length:strlen(directoryId) buffer:buffer maxLength:sizeof(buffer)], -1);
+}
+
 #pragma mark - Encryption & Decryption
 
 - (void)testEncryptionAndDecryptionOfPathComponents {
@@ -170,6 +266,40 @@
 	XCTAssertEqualObjects(cleartextPathComponent, decrypted);
 }
 
+- (void)testEncryptionOfUTF8StringPathComponents {
+	NSString *cleartextPathComponent = @"So oder so ähnlich könnte Ihr Ordner heißen";
+	NSString *directoryId = @"63fb3905-9de6-4e0d-9cde-c6494cd6e0ad";
+	NSUInteger cleartextLength = [cleartextPathComponent lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	char buffer[2 * (cleartextLength + 16)];
+	NSInteger length = [self.cryptor encryptFilenameUTF8String:cleartextPathComponent.UTF8String length:cleartextLength insideDirectoryWithIdUTF8String:directoryId.UTF8String length:directoryId.length buffer:buffer maxLength:sizeof(buffer)];
+	XCTAssertGreaterThan(length, 0);
+	NSString *ciphertextPathComponent = [[NSString alloc] initWithBytes:buffer length:length encoding:NSASCIIStringEncoding];
+	XCTAssertEqualObjects([self.cryptor encryptFilename:cleartextPathComponent insideDirectoryWithId:directoryId], ciphertextPathComponent);
+	XCTAssertEqual([self.cryptor encryptFilenameUTF8String:cleartextPathComponent.UTF8String length:cleartextLength insideDirectoryWithIdUTF8String:directoryId.UTF8String length:directoryId.length buffer:buffer maxLength:length - 1], -1);
+}
+
+- (void)testEncryptedFilenameLength {
+	for (NSString *filename in @[@"", @"a", @"WELCOME TO YOUR VAULT.rtf", @"So oder so ähnlich könnte Ihr Ordner heißen", [@"" stringByPaddingToLength:300 withString:@"x" startingAtIndex:0]]) {
+		NSUInteger encryptedFilenameLength = [self.cryptor encryptFilename:filename insideDirectoryWithId:@"foo-id"].length;
+		XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilename:filename], encryptedFilenameLength);
+		NSUInteger filenameLength = [filename lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+		XCTAssertGreaterThanOrEqual([self.cryptor maxFilenameLengthForEncryptedFilenameLength:encryptedFilenameLength], filenameLength);
+		XCTAssertLessThanOrEqual([self.cryptor encryptedFilenameLengthForFilenameLength:[self.cryptor maxFilenameLengthForEncryptedFilenameLength:encryptedFilenameLength]], encryptedFilenameLength);
+		XCTAssertGreaterThan([self.cryptor encryptedFilenameLengthForFilenameLength:[self.cryptor maxFilenameLengthForEncryptedFilenameLength:encryptedFilenameLength] + 1], encryptedFilenameLength);
+	}
+	XCTAssertEqual([self.cryptor maxFilenameLengthForEncryptedFilenameLength:8], 0);
+
+	// base32 pads the 16 bytes synthetic iv and the filename to blocks of 5 bytes, 8 characters each:
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:0], 32);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:4], 32);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:5], 40);
+
+	// vault version 5 shortens encrypted filenames longer than 129 characters:
+	XCTAssertEqual([self.cryptor maxFilenameLengthForEncryptedFilenameLength:129], 64);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:64], 128);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:65], 136);
+}
+
 - (void)testEncryptionAndDecryptionWithNewMasterKey {
 	// create key:
 	SETOMasterKey *key = [[SETOMasterKey alloc] init];
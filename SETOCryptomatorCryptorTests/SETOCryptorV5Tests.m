@@ -8,6 +8,8 @@
 
 #import <XCTest/XCTest.h>
 #import "SETOCryptorV5.h"
+#import "SETOFileContentDecryptor.h"
+#import "SETOFileContentEncryptor.h"
 #import "SETOMasterKey.h"
 #import "SETOMasterKeyFile.h"
 
@@ -149,6 +151,146 @@
 	[self waitForExpectationsWithTimeout:1.0 handler:nil];
 }
 
+- (void)testConcurrentLargeFileDecryption {
+	self.cryptor.maxConcurrentChunkOperationCount = 4;
+	XCTestExpectation *decryptionFinished = [self expectationWithDescription:@"decryption of file finished"];
+
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v5" ofType:@"aes"];
+	NSString *fileOutPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"cleartext.jpg"];
+
+	[self.cryptor decryptFileAtPath:largeCiphertextPath toPath:fileOutPath callback:^(NSError *error) {
+		XCTAssertNil(error);
+		
+		NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+		XCTAssertTrue([[NSFileManager defaultManager] contentsEqualAtPath:fileOutPath andPath:largeCleartextPath]);
+		[[NSFileManager defaultManager] removeItemAtPath:fileOutPath error:NULL];
+		
+		[decryptionFinished fulfill];
+	} progress:^(CGFloat progress) {
+		NSLog(@"decryption progress: %.2f", progress);
+		// ignore
+	}];
+
+	[self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+- (void)testRangeDecryption {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v5" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSData *cleartext = [NSData dataWithContentsOfFile:largeCleartextPath];
+
+	// within a single chunk:
+	NSError *error;
+	NSData *decrypted = [self.cryptor decryptRange:NSMakeRange(100, 1000) ofFileAtPath:largeCiphertextPath error:&error];
+	XCTAssertNil(error);
+	XCTAssertEqualObjects([cleartext subdataWithRange:NSMakeRange(100, 1000)], decrypted);
+
+	// across chunk boundaries:
+	decrypted = [self.cryptor decryptRange:NSMakeRange(32 * 1024 - 10, 64 * 1024) ofFileAtPath:largeCiphertextPath error:&error];
+	XCTAssertNil(error);
+	XCTAssertEqualObjects([cleartext subdataWithRange:NSMakeRange(32 * 1024 - 10, 64 * 1024)], decrypted);
+
+	// beyond end of file:
+	decrypted = [self.cryptor decryptRange:NSMakeRange(cleartext.length - 10, 100) ofFileAtPath:largeCiphertextPath error:&error];
+	XCTAssertNil(error);
+	XCTAssertEqualObjects([cleartext subdataWithRange:NSMakeRange(cleartext.length - 10, 10)], decrypted);
+	decrypted = [self.cryptor decryptRange:NSMakeRange(cleartext.length, 100) ofFileAtPath:largeCiphertextPath error:&error];
+	XCTAssertNil(error);
+	XCTAssertEqual(0, decrypted.length);
+
+	// range length up to NSUIntegerMax must not overflow:
+	decrypted = [self.cryptor decryptRange:NSMakeRange(cleartext.length - 10, NSUIntegerMax) ofFileAtPath:largeCiphertextPath error:&error];
+	XCTAssertNil(error);
+	XCTAssertEqualObjects([cleartext subdataWithRange:NSMakeRange(cleartext.length - 10, 10)], decrypted);
+}
+
+- (void)testRangeDecryptionOfUnauthenticFile {
+	// write unauthentic content test data to file:
+	NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"test.aes"];
+	NSString *encryptedFileString = @"2HrK7wEaE49Q52Y3b38CkcZpKV+8WQLDk+djHO+xUmu8XiHfD6XOwdO9iSsyvJnQTQsx9TRBZoQ16W32Bpu/6zXyDBMP0xaUwNtqWq8FWIhAqwCftw+3oHd3E0AB2Qb/wn52zvGeb1sNZF3+1BWpTP9hsAzzqBr94QhlEt8BxOjc5sr+lu939sHil6c6w2i3kDaG";
+	NSData *encryptedFileData = [[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0];
+	[encryptedFileData writeToFile:filePath atomically:YES];
+
+	NSError *error;
+	NSData *decrypted = [self.cryptor decryptRange:NSMakeRange(0, 5) ofFileAtPath:filePath error:&error];
+	XCTAssertNil(decrypted);
+	XCTAssertEqualObjects(kSETOCryptorErrorDomain, error.domain);
+	XCTAssertEqual(SETOCryptorAuthenticationFailedError, error.code);
+	[[NSFileManager defaultManager] removeItemAtPath:filePath error:NULL];
+}
+
+- (void)testPartialRewrite {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v5" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSString *ciphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"test.aes"];
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+	[[NSFileManager defaultManager] copyItemAtPath:largeCiphertextPath toPath:ciphertextPath error:NULL];
+	NSMutableData *expected = [NSMutableData dataWithContentsOfFile:largeCleartextPath];
+
+	// across chunk boundary:
+	NSError *error;
+	NSData *patch = [@"Wie macht der Uhu? Woot, woot!" dataUsingEncoding:NSUTF8StringEncoding];
+	XCTAssertTrue([self.cryptor writeData:patch toFileAtPath:ciphertextPath atOffset:32 * 1024 - 10 error:&error]);
+	XCTAssertNil(error);
+	[expected replaceBytesInRange:NSMakeRange(32 * 1024 - 10, patch.length) withBytes:patch.bytes];
+
+	// beyond end of file:
+	NSUInteger offset = expected.length - 10;
+	XCTAssertTrue([self.cryptor writeData:patch toFileAtPath:ciphertextPath atOffset:offset error:&error]);
+	XCTAssertNil(error);
+	[expected replaceBytesInRange:NSMakeRange(offset, expected.length - offset) withBytes:patch.bytes length:patch.length];
+
+	// gap behind end of file:
+	XCTAssertFalse([self.cryptor writeData:patch toFileAtPath:ciphertextPath atOffset:expected.length + 1 error:&error]);
+	XCTAssertNotNil(error);
+
+	// verify:
+	error = nil;
+	NSData *decrypted = [self.cryptor decryptRange:NSMakeRange(0, NSUIntegerMax) ofFileAtPath:ciphertextPath error:&error];
+	XCTAssertNil(error);
+	XCTAssertEqualObjects(expected, decrypted);
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+}
+
+- (void)testAppendAndTruncate {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v5" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSString *ciphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"test.aes"];
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+	[[NSFileManager defaultManager] copyItemAtPath:largeCiphertextPath toPath:ciphertextPath error:NULL];
+	NSMutableData *expected = [NSMutableData dataWithContentsOfFile:largeCleartextPath];
+
+	// append:
+	NSError *error;
+	NSData *appendix = [NSMutableData dataWithLength:40 * 1024];
+	XCTAssertTrue([self.cryptor appendData:appendix toFileAtPath:ciphertextPath error:&error]);
+	XCTAssertNil(error);
+	[expected appendData:appendix];
+	XCTAssertEqualObjects(expected, [self.cryptor decryptRange:NSMakeRange(0, NSUIntegerMax) ofFileAtPath:ciphertextPath error:&error]);
+
+	// truncate within chunk:
+	XCTAssertTrue([self.cryptor truncateFileAtPath:ciphertextPath toCleartextSize:100 * 1024 + 1 error:&error]);
+	XCTAssertNil(error);
+	expected.length = 100 * 1024 + 1;
+	XCTAssertEqualObjects(expected, [self.cryptor decryptRange:NSMakeRange(0, NSUIntegerMax) ofFileAtPath:ciphertextPath error:&error]);
+	NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:ciphertextPath error:NULL];
+	XCTAssertEqual(88 + [self.cryptor ciphertextSizeFromCleartextSize:expected.length], [fileAttributes fileSize]);
+
+	// truncate at chunk boundary:
+	XCTAssertTrue([self.cryptor truncateFileAtPath:ciphertextPath toCleartextSize:64 * 1024 error:&error]);
+	XCTAssertNil(error);
+	expected.length = 64 * 1024;
+	XCTAssertEqualObjects(expected, [self.cryptor decryptRange:NSMakeRange(0, NSUIntegerMax) ofFileAtPath:ciphertextPath error:&error]);
+
+	// extend:
+	XCTAssertTrue([self.cryptor truncateFileAtPath:ciphertextPath toCleartextSize:70 * 1024 error:&error]);
+	XCTAssertNil(error);
+	expected.length = 70 * 1024;
+	XCTAssertEqualObjects(expected, [self.cryptor decryptRange:NSMakeRange(0, NSUIntegerMax) ofFileAtPath:ciphertextPath error:&error]);
+	XCTAssertNil(error);
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+}
+
 - (void)testFancyUnicodeFoldernameDecryption {
 	NSString *foo = @"EWQR5HC36SSEBHEWL6LKDDWZSIAJQNY57SJRRNEZU2TMHYW3TKJROAVELZBDI3GBMY4IIZ3CUGZ2BGXLNPZXM5YY7AA5JDEI5XBQ====";
 	NSString *decrypted = [self.cryptor decryptFilename:foo insideDirectoryWithId:@"e332c87c-70c6-4054-a256-543624585fd7"];
@@ -225,6 +367,192 @@
 	[self waitForExpectationsWithTimeout:0.5 handler:nil];
 }
 
+- (void)testConcurrentLargeFileEncryption {
+	self.cryptor.maxConcurrentChunkOperationCount = 4;
+
+	// encrypt:
+	XCTestExpectation *encryptionFinished = [self expectationWithDescription:@"encryption of file finished"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSString *ciphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"cleartext.aes"];
+	[self.cryptor encryptFileAtPath:largeCleartextPath toPath:ciphertextPath callback:^(NSError *error) {
+		XCTAssertNil(error);
+		[encryptionFinished fulfill];
+	} progress:^(CGFloat progress) {
+		NSLog(@"encryption progress: %.2f", progress);
+		// ignore
+	}];
+
+	[self waitForExpectationsWithTimeout:1.0 handler:nil];
+
+	// authenticate:
+	XCTestExpectation *authenticationFinished = [self expectationWithDescription:@"authentication of authentic file finished"];
+	[self.cryptor authenticateFileAtPath:ciphertextPath callback:^(NSError *error) {
+		XCTAssertNil(error);
+		[authenticationFinished fulfill];
+	} progress:^(CGFloat progress) {
+		NSLog(@"authentication progress: %.2f", progress);
+		// ignore
+	}];
+
+	[self waitForExpectationsWithTimeout:1.0 handler:nil];
+
+	// decrypt sequentially:
+	self.cryptor.maxConcurrentChunkOperationCount = 1;
+	XCTestExpectation *decryptionFinished = [self expectationWithDescription:@"decryption of file finished"];
+	NSString *cleartextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"cleartext.jpg"];
+	[self.cryptor decryptFileAtPath:ciphertextPath toPath:cleartextPath callback:^(NSError *error) {
+		XCTAssertNil(error);
+		
+		XCTAssertTrue([[NSFileManager defaultManager] contentsEqualAtPath:cleartextPath andPath:largeCleartextPath]);
+		[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+		[[NSFileManager defaultManager] removeItemAtPath:cleartextPath error:NULL];
+		
+		[decryptionFinished fulfill];
+	} progress:^(CGFloat progress) {
+		NSLog(@"decryption progress: %.2f", progress);
+		// ignore
+	}];
+
+	[self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+- (void)testStreamingEncryption {
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSData *cleartext = [NSData dataWithContentsOfFile:largeCleartextPath];
+
+	// encrypt in pieces of varying size, some smaller and some larger than a chunk:
+	NSError *error;
+	SETOFileContentEncryptor *encryptor = [self.cryptor fileContentEncryptorWithError:&error];
+	XCTAssertNotNil(encryptor);
+	XCTAssertNil(error);
+	NSMutableData *ciphertext = [NSMutableData data];
+	NSUInteger offset = 0;
+	NSUInteger pieceLength = 1;
+	while (offset < cleartext.length) {
+		NSUInteger length = MIN(pieceLength, cleartext.length - offset);
+		NSData *piece = [encryptor updateWithData:[cleartext subdataWithRange:NSMakeRange(offset, length)] error:&error];
+		XCTAssertNotNil(piece);
+		[ciphertext appendData:piece];
+		offset += length;
+		pieceLength = pieceLength * 7 % (100 * 1024) + 1;
+	}
+	NSData *lastPiece = [encryptor finishWithError:&error];
+	XCTAssertNotNil(lastPiece);
+	XCTAssertNil(error);
+	[ciphertext appendData:lastPiece];
+	XCTAssertNil([encryptor updateWithData:cleartext error:&error]);
+	XCTAssertNotNil(error);
+	XCTAssertEqual(88 + [self.cryptor ciphertextSizeFromCleartextSize:cleartext.length], ciphertext.length);
+
+	// decrypt:
+	NSString *ciphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"cleartext.aes"];
+	[ciphertext writeToFile:ciphertextPath atomically:YES];
+	error = nil;
+	XCTAssertEqualObjects(cleartext, [self.cryptor decryptRange:NSMakeRange(0, NSUIntegerMax) ofFileAtPath:ciphertextPath error:&error]);
+	XCTAssertNil(error);
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+}
+
+- (void)testStreamingEncryptionOfEmptyFile {
+	NSError *error;
+	SETOFileContentEncryptor *encryptor = [self.cryptor fileContentEncryptorWithError:&error];
+	XCTAssertNotNil(encryptor);
+	NSMutableData *ciphertext = [NSMutableData dataWithData:[encryptor updateWithData:[NSData data] error:&error]];
+	[ciphertext appendData:[encryptor finishWithError:&error]];
+	XCTAssertNil(error);
+	XCTAssertEqual(88, ciphertext.length);
+
+	NSString *ciphertextPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"empty.aes"];
+	[ciphertext writeToFile:ciphertextPath atomically:YES];
+	XCTAssertEqualObjects([NSData data], [self.cryptor decryptRange:NSMakeRange(0, 1) ofFileAtPath:ciphertextPath error:&error]);
+	XCTAssertNil(error);
+	[[NSFileManager defaultManager] removeItemAtPath:ciphertextPath error:NULL];
+}
+
+- (void)testStreamingDecryptionFromInputStream {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v5" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSInputStream *inputStream = [NSInputStream inputStreamWithFileAtPath:largeCiphertextPath];
+
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithInputStream:inputStream error:&error];
+	XCTAssertNotNil(decryptor);
+	NSMutableData *cleartext = [NSMutableData data];
+	NSData *chunk;
+	while ((chunk = [decryptor readChunkWithError:&error]).length > 0) {
+		XCTAssertLessThanOrEqual(chunk.length, 32 * 1024);
+		[cleartext appendData:chunk];
+	}
+	XCTAssertNotNil(chunk);
+	XCTAssertNil(error);
+	XCTAssertEqualObjects([NSData dataWithContentsOfFile:largeCleartextPath], cleartext);
+	[inputStream close];
+}
+
+- (void)testStreamingDecryptionFromShortReadingSource {
+	NSString *largeCiphertextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"ciphertext_v5" ofType:@"aes"];
+	NSString *largeCleartextPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"cleartext" ofType:@"jpg"];
+	NSData *ciphertext = [NSData dataWithContentsOfFile:largeCiphertextPath];
+
+	// return at most 1000 bytes per read, like a socket:
+	__block NSUInteger offset = 0;
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithSource:^NSInteger(uint8_t *buffer, NSUInteger maxLength) {
+		NSUInteger length = MIN(MIN(maxLength, 1000), ciphertext.length - offset);
+		[ciphertext getBytes:buffer range:NSMakeRange(offset, length)];
+		offset += length;
+		return length;
+	} error:&error];
+	XCTAssertNotNil(decryptor);
+	NSMutableData *cleartext = [NSMutableData data];
+	NSData *chunk;
+	while ((chunk = [decryptor readChunkWithError:&error]).length > 0) {
+		[cleartext appendData:chunk];
+	}
+	XCTAssertNil(error);
+	XCTAssertEqualObjects([NSData dataWithContentsOfFile:largeCleartextPath], cleartext);
+}
+
+- (void)testStreamingDecryptionOfUnauthenticContent {
+	NSString *encryptedFileString = @"2HrK7wEaE49Q52Y3b38CkcZpKV+8WQLDk+djHO+xUmu8XiHfD6XOwdO9iSsyvJnQTQsx9TRBZoQ16W32Bpu/6zXyDBMP0xaUwNtqWq8FWIhAqwCftw+3oHd3E0AB2Qb/wn52zvGeb1sNZF3+1BWpTP9hsAzzqBr94QhlEt8BxOjc5sr+lu939sHil6c6w2i3kDaG";
+	NSData *encryptedFileData = [[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0];
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithInputStream:[NSInputStream inputStreamWithData:encryptedFileData] error:&error];
+	XCTAssertNil([decryptor readChunkWithError:&error]);
+	XCTAssertEqualObjects(kSETOCryptorErrorDomain, error.domain);
+	XCTAssertEqual(SETOCryptorAuthenticationFailedError, error.code);
+}
+
+- (void)testStreamingDecryptionOfTruncatedHeader {
+	NSString *encryptedFileString = @"2HrK7wEaE49Q52Y3b38CkcZpKV+8WQLDk+djHO+xUmu8XiHfD6XOwdO9iSsyvJnQTQsx9TRBZoQ16W32";
+	NSData *encryptedFileData = [[NSData alloc] initWithBase64EncodedString:encryptedFileString options:0];
+	NSError *error;
+	SETOFileContentDecryptor *decryptor = [self.cryptor fileContentDecryptorWithInputStream:[NSInputStream inputStreamWithData:encryptedFileData] error:&error];
+	XCTAssertNil([decryptor readChunkWithError:&error]);
+	XCTAssertEqual(SETOCryptorCorruptedFileHeaderError, error.code);
+}
+
+#pragma mark - Path Resolution
+
+- (void)testPathResolution {
+	NSString *rootPath = [@"d" stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@""] substringToIndex:2]];
+	rootPath = [rootPath stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@""] substringFromIndex:2]];
+	NSString *fooDirectoryNodePath = [rootPath stringByAppendingPathComponent:[@"0" stringByAppendingString:[self.cryptor encryptFilename:@"foo" insideDirectoryWithId:@""]]];
+	NSString *fooPath = [@"d" stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@"foo-id"] substringToIndex:2]];
+	fooPath = [fooPath stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@"foo-id"] substringFromIndex:2]];
+	NSString *barNodePath = [fooPath stringByAppendingPathComponent:[self.cryptor encryptFilename:@"bar.txt" insideDirectoryWithId:@"foo-id"]];
+
+	// directory nodes are files prefixed by 0:
+	SETOCryptorDirectoryIdProvider provider = ^NSString *(NSString *ciphertextPath, NSError **error) {
+		XCTAssertEqualObjects(ciphertextPath, fooDirectoryNodePath);
+		return @"foo-id";
+	};
+	NSError *error;
+	XCTAssertEqualObjects([self.cryptor ciphertextDirectoryPathForCleartextPath:@"/foo" directoryIdProvider:provider error:&error], fooPath);
+	XCTAssertEqualObjects([self.cryptor ciphertextPathForCleartextPath:@"/foo/bar.txt" directoryIdProvider:provider error:&error], barNodePath);
+	XCTAssertNil(error);
+}
+
 #pragma mark - Chunk Sizes
 
 - (void)testCleartextSize {
@@ -41,6 +41,22 @@
 	XCTAssertEqualObjects(ciphertext, @"AkUvrvKgAJSYRgZzsyf5Fqp7MdJQQeE_GIjpiFINltrHhqNkSTtWA1I=");
 }
 
+- (void)testEncryptedFilenameLength {
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilename:@"WELCOME TO YOUR VAULT.rtf"], @"AkUvrvKgAJSYRgZzsyf5Fqp7MdJQQeE_GIjpiFINltrHhqNkSTtWA1I=".length);
+
+	// base64url pads the 16 bytes synthetic iv and the filename to blocks of 3 bytes, 4 characters each:
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:0], 24);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:2], 24);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:3], 28);
+	XCTAssertEqual([self.cryptor maxFilenameLengthForEncryptedFilenameLength:8], 0);
+
+	// vault version 7 shortens filenames longer than 220 characters including the .c9r extension:
+	NSUInteger maxEncryptedFilenameLength = 220 - @".c9r".length;
+	XCTAssertEqual([self.cryptor maxFilenameLengthForEncryptedFilenameLength:maxEncryptedFilenameLength], 146);
+	XCTAssertEqual([self.cryptor encryptedFilenameLengthForFilenameLength:146], maxEncryptedFilenameLength);
+	XCTAssertGreaterThan([self.cryptor encryptedFilenameLengthForFilenameLength:147], maxEncryptedFilenameLength);
+}
+
 #pragma mark - Decryption
 
 - (void)testFilenameDecryption {
@@ -49,4 +65,68 @@
 	XCTAssertEqualObjects(cleartext, @"WELCOME TO YOUR VAULT.rtf");
 }
 
+- (void)testMalformedFilenameDecryption {
+	NSString *ciphertext = @"AkUvrvKgAJSYRgZzsyf5Fqp7MdJQQeE_GIjpiFINltrHhqNkSTtWA1I=";
+	XCTAssertNil([self.cryptor decryptFilename:@".DS_Store" insideDirectoryWithId:@""]);
+	XCTAssertNil([self.cryptor decryptFilename:@"AAAAAAAAAAAAAAAAAAAAAA==" insideDirectoryWithId:@""]);
+	XCTAssertNil([self.cryptor decryptFilename:[ciphertext stringByReplacingOccurrencesOfString:@"_" withString:@"/"] insideDirectoryWithId:@""]);
+	XCTAssertNil([self.cryptor decryptFilename:[ciphertext stringByReplacingOccurrencesOfString:@"=" withString:@""] insideDirectoryWithId:@""]);
+	XCTAssertNil([self.cryptor decryptFilename:[ciphertext stringByAppendingString:@"===="] insideDirectoryWithId:@""]);
+}
+
+- (void)testBatchFilenameDecryption {
+	NSString *ciphertext = @"AkUvrvKgAJSYRgZzsyf5Fqp7MdJQQeE_GIjpiFINltrHhqNkSTtWA1I=";
+	NSDictionary *cleartexts = [self.cryptor decryptFilenames:@[ciphertext, @"Test"] insideDirectoryWithId:@""];
+	XCTAssertEqualObjects(cleartexts, @{ciphertext: @"WELCOME TO YOUR VAULT.rtf"});
+}
+
+- (void)testUTF8StringFilenameDecryption {
+	const char *ciphertext = "AkUvrvKgAJSYRgZzsyf5Fqp7MdJQQeE_GIjpiFINltrHhqNkSTtWA1I=";
+	const char *cleartext = "WELCOME TO YOUR VAULT.rtf";
+	char buffer[strlen(ciphertext)];
+	NSInteger length = [self.cryptor decryptFilenameUTF8String:ciphertext length:strlen(ciphertext) insideDirectoryWithIdUTF8String:"" length:0 buffer:buffer maxLength:sizeof(buffer)];
+	XCTAssertEqual(length, (NSInteger)strlen(cleartext));
+	XCTAssertEqual(memcmp(buffer, cleartext, strlen(cleartext)), 0);
+	length = [self.cryptor encryptFilenameUTF8String:cleartext length:strlen(cleartext) insideDirectoryWithIdUTF8String:"" length:0 buffer:buffer maxLength:sizeof(buffer)];
+	XCTAssertEqual(length, (NSInteger)strlen(ciphertext));
+	XCTAssertEqual([self.cryptor decryptFilenameUTF8String:buffer length:length insideDirectoryWithIdUTF8String:"" length:0 buffer:buffer maxLength:sizeof(buffer)], (NSInteger)strlen(cleartext));
+	XCTAssertEqual(memcmp(buffer, cleartext, strlen(cleartext)), 0);
+}
+
+#pragma mark - Path Resolution
+
+- (void)testPathResolution {
+	NSString *rootPath = [@"d" stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@""] substringToIndex:2]];
+	rootPath = [rootPath stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@""] substringFromIndex:2]];
+	NSString *fooNodePath = [rootPath stringByAppendingPathComponent:[[self.cryptor encryptFilename:@"foo" insideDirectoryWithId:@""] stringByAppendingString:@".c9r"]];
+	NSString *fooPath = [@"d" stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@"foo-id"] substringToIndex:2]];
+	fooPath = [fooPath stringByAppendingPathComponent:[[self.cryptor encryptDirectoryId:@"foo-id"] substringFromIndex:2]];
+	NSString *barNodePath = [fooPath stringByAppendingPathComponent:[[self.cryptor encryptFilename:@"bar.txt" insideDirectoryWithId:@"foo-id"] stringByAppendingString:@".c9r"]];
+
+	__block NSUInteger providerCallCount = 0;
+	SETOCryptorDirectoryIdProvider provider = ^NSString *(NSString *ciphertextPath, NSError **error) {
+		providerCallCount++;
+		return [ciphertextPath isEqualToString:fooNodePath] ? @"foo-id" : nil;
+	};
+	NSError *error;
+	XCTAssertEqualObjects([self.cryptor ciphertextDirectoryPathForCleartextPath:@"/" directoryIdProvider:provider error:&error], rootPath);
+	XCTAssertEqualObjects([self.cryptor ciphertextPathForCleartextPath:@"/" directoryIdProvider:provider error:&error], rootPath);
+	XCTAssertEqualObjects([self.cryptor ciphertextPathForCleartextPath:@"/foo" directoryIdProvider:provider error:&error], fooNodePath);
+	XCTAssertEqual(providerCallCount, 0);
+	XCTAssertEqualObjects([self.cryptor ciphertextDirectoryPathForCleartextPath:@"/foo/" directoryIdProvider:provider error:&error], fooPath);
+	XCTAssertEqualObjects([self.cryptor ciphertextPathForCleartextPath:@"/foo/bar.txt" directoryIdProvider:provider error:&error], barNodePath);
+	XCTAssertNil(error);
+
+	// directory IDs are memoized until invalidated:
+	XCTAssertEqual(providerCallCount, 1);
+	[self.cryptor invalidateResolvedPathsWithPrefix:@"/foo"];
+	XCTAssertEqualObjects([self.cryptor ciphertextPathForCleartextPath:@"/foo/bar.txt" directoryIdProvider:provider error:&error], barNodePath);
+	XCTAssertEqual(providerCallCount, 2);
+
+	// failing lookup:
+	XCTAssertNil([self.cryptor ciphertextPathForCleartextPath:@"/baz/bar.txt" directoryIdProvider:provider error:&error]);
+	XCTAssertEqualObjects(error.domain, kSETOCryptorErrorDomain);
+	XCTAssertEqual(error.code, SETOCryptorDirectoryIdLookupFailedError);
+}
+
 @end
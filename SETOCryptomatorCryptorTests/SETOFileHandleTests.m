@@ -0,0 +1,65 @@
+//
+//  SETOFileHandleTests.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SETOFileHandle.h"
+
+@interface SETOFileHandleTests : XCTestCase
+@property (nonatomic, strong) NSString *path;
+@end
+
+@implementation SETOFileHandleTests
+
+- (void)setUp {
+	[super setUp];
+	self.path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"test.bin"];
+}
+
+- (void)tearDown {
+	[[NSFileManager defaultManager] removeItemAtPath:self.path error:NULL];
+	[super tearDown];
+}
+
+- (void)testPositionalReadAndWrite {
+	NSError *error;
+	SETOFileHandle *output = [SETOFileHandle fileHandleForWritingAtPath:self.path error:&error];
+	XCTAssertNotNil(output);
+	XCTAssertNil(error);
+	XCTAssertTrue([output writeBytes:"world" length:5 atOffset:6]);
+	XCTAssertTrue([output writeBytes:"hello " length:6 atOffset:0]);
+	XCTAssertEqual(11, output.fileSize);
+	[output closeFile];
+
+	SETOFileHandle *input = [SETOFileHandle fileHandleForReadingAtPath:self.path error:&error];
+	XCTAssertNotNil(input);
+	char buffer[16] = {0};
+	XCTAssertEqual(5, [input readBytes:buffer length:5 atOffset:6]);
+	XCTAssertEqual(0, memcmp(buffer, "world", 5));
+	XCTAssertEqual(3, [input readBytes:buffer length:sizeof(buffer) atOffset:8]); // end of file
+	XCTAssertEqual(0, [input readBytes:buffer length:sizeof(buffer) atOffset:11]);
+	[input closeFile];
+}
+
+- (void)testTruncate {
+	[[@"hello world" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.path atomically:YES];
+	SETOFileHandle *fileHandle = [SETOFileHandle fileHandleForUpdatingAtPath:self.path error:NULL];
+	XCTAssertTrue([fileHandle truncateAtOffset:5]);
+	XCTAssertEqual(5, fileHandle.fileSize);
+	[fileHandle closeFile];
+	XCTAssertEqualObjects(@"hello", [NSString stringWithContentsOfFile:self.path encoding:NSUTF8StringEncoding error:NULL]);
+}
+
+- (void)testOpenNonexistentFile {
+	NSError *error;
+	SETOFileHandle *fileHandle = [SETOFileHandle fileHandleForReadingAtPath:[self.path stringByAppendingPathExtension:@"missing"] error:&error];
+	XCTAssertNil(fileHandle);
+	XCTAssertEqualObjects(NSPOSIXErrorDomain, error.domain);
+	XCTAssertEqual(ENOENT, error.code);
+}
+
+@end
@@ -0,0 +1,108 @@
+//
+//  SETOFilenameMigratorTests.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SETOFilenameMigrator.h"
+#import "NSData+SETOBase32Encoding.h"
+#import "NSData+SETOBase64urlEncoding.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+@interface SETOFilenameMigratorTests : XCTestCase
+@property (nonatomic, strong) NSString *vaultPath;
+@property (nonatomic, strong) NSString *directoryPath;
+@end
+
+@implementation SETOFilenameMigratorTests
+
+- (void)setUp {
+	[super setUp];
+	self.vaultPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"migration-vault"];
+	self.directoryPath = [self.vaultPath stringByAppendingPathComponent:@"d/AB/CDEFGHIJKLMNOPQRSTUVWXYZ234567ABCD"];
+	[[NSFileManager defaultManager] removeItemAtPath:self.vaultPath error:NULL];
+	XCTAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath:self.directoryPath withIntermediateDirectories:YES attributes:nil error:NULL]);
+}
+
+- (void)tearDown {
+	[[NSFileManager defaultManager] removeItemAtPath:self.vaultPath error:NULL];
+	[super tearDown];
+}
+
+- (void)testMigration {
+	// vault version 5 nodes:
+	NSString *fileName = @"AkUvrvKgAJSYRgZzsyf5Fqp7MdJQQeE_GIjpiFINltrHhqNkSTtWA1I=";
+	NSString *v5FileName = [[NSData seto_dataWithBase64urlEncodedString:fileName] seto_base32EncodedString];
+	[self createFileNamed:v5FileName contents:@"file"];
+	NSData *directoryCiphertext = [NSData dataWithBytes:"0123456789abcdef0123456789abcdef" length:32];
+	[self createFileNamed:[@"0" stringByAppendingString:[directoryCiphertext seto_base32EncodedString]] contents:@"directory-id"];
+	[self createFileNamed:@".DS_Store" contents:@""];
+
+	// long name with metadata:
+	NSMutableData *longCiphertext = [NSMutableData dataWithLength:200];
+	arc4random_buf(longCiphertext.mutableBytes, longCiphertext.length);
+	NSString *v5LongName = [longCiphertext seto_base32EncodedString];
+	NSData *v5LongNameData = [v5LongName dataUsingEncoding:NSUTF8StringEncoding];
+	unsigned char v5Hash[CC_SHA1_DIGEST_LENGTH];
+	CC_SHA1(v5LongNameData.bytes, (CC_LONG)v5LongNameData.length, v5Hash);
+	NSString *v5ShortName = [[[NSData dataWithBytes:v5Hash length:sizeof(v5Hash)] seto_base32EncodedString] stringByAppendingString:@".lng"];
+	NSString *metadataDirectoryPath = [NSString stringWithFormat:@"%@/m/%@/%@", self.vaultPath, [v5ShortName substringToIndex:2], [v5ShortName substringWithRange:NSMakeRange(2, 2)]];
+	XCTAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath:metadataDirectoryPath withIntermediateDirectories:YES attributes:nil error:NULL]);
+	XCTAssertTrue([v5LongNameData writeToFile:[metadataDirectoryPath stringByAppendingPathComponent:v5ShortName] atomically:YES]);
+	[self createFileNamed:v5ShortName contents:@"long"];
+
+	// migrate twice, the second run must not change anything:
+	__block CGFloat lastProgress = 0.0;
+	for (NSUInteger i = 0; i < 2; i++) {
+		__block NSError *migrationError;
+		[SETOFilenameMigrator migrateVaultAtPath:self.vaultPath callback:^(NSError *error) {
+			migrationError = error;
+		} progress:^(CGFloat progress) {
+			lastProgress = progress;
+		}];
+		XCTAssertNil(migrationError);
+		XCTAssertEqual(lastProgress, 1.0);
+	}
+
+	// vault version 7 nodes:
+	NSString *v7LongName = [[longCiphertext seto_base64urlEncodedString] stringByAppendingString:@".c9r"];
+	NSData *v7LongNameData = [v7LongName dataUsingEncoding:NSUTF8StringEncoding];
+	unsigned char v7Hash[CC_SHA1_DIGEST_LENGTH];
+	CC_SHA1(v7LongNameData.bytes, (CC_LONG)v7LongNameData.length, v7Hash);
+	NSString *v7ShortName = [[[NSData dataWithBytes:v7Hash length:sizeof(v7Hash)] seto_base64urlEncodedString] stringByAppendingString:@".c9s"];
+	NSArray *expectedNodeNames = @[[fileName stringByAppendingString:@".c9r"], [[directoryCiphertext seto_base64urlEncodedString] stringByAppendingString:@".c9r"], v7ShortName, @".DS_Store"];
+	NSArray *nodeNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:self.directoryPath error:NULL];
+	XCTAssertEqualObjects([NSSet setWithArray:nodeNames], [NSSet setWithArray:expectedNodeNames]);
+	XCTAssertEqualObjects([self contentsOfNodeAtPath:expectedNodeNames[0]], @"file");
+	XCTAssertEqualObjects([self contentsOfNodeAtPath:[expectedNodeNames[1] stringByAppendingPathComponent:@"dir.c9r"]], @"directory-id");
+	XCTAssertEqualObjects([self contentsOfNodeAtPath:[v7ShortName stringByAppendingPathComponent:@"name.c9s"]], v7LongName);
+	XCTAssertEqualObjects([self contentsOfNodeAtPath:[v7ShortName stringByAppendingPathComponent:@"contents.c9r"]], @"long");
+}
+
+- (void)testMigrationWithMissingLongNameMetadata {
+	[self createFileNamed:@"ABCDEFGH.lng" contents:@"long"];
+	__block NSError *migrationError;
+	[SETOFilenameMigrator migrateVaultAtPath:self.vaultPath callback:^(NSError *error) {
+		migrationError = error;
+	} progress:nil];
+	XCTAssertNotNil(migrationError);
+	XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[self.directoryPath stringByAppendingPathComponent:@"ABCDEFGH.lng"]]);
+}
+
+#pragma mark - Helpers
+
+- (void)createFileNamed:(NSString *)name contents:(NSString *)contents {
+	NSString *path = [self.directoryPath stringByAppendingPathComponent:name];
+	XCTAssertTrue([[contents dataUsingEncoding:NSUTF8StringEncoding] writeToFile:path atomically:YES]);
+}
+
+- (NSString *)contentsOfNodeAtPath:(NSString *)relativePath {
+	NSData *contents = [NSData dataWithContentsOfFile:[self.directoryPath stringByAppendingPathComponent:relativePath]];
+	return [[NSString alloc] initWithData:contents encoding:NSUTF8StringEncoding];
+}
+
+@end
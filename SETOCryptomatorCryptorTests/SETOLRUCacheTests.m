@@ -0,0 +1,98 @@
+//
+//  SETOLRUCacheTests.m
+//  SETOCryptomatorCryptor
+//
+//  Created by agent on 17.10.26.
+//  Copyright © 2026 Skymatic. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SETOLRUCache.h"
+
+@interface SETOLRUCacheTests : XCTestCase
+@end
+
+@implementation SETOLRUCacheTests
+
+- (void)testEvictionOfLeastRecentlyUsedEntry {
+	SETOLRUCache *cache = [[SETOLRUCache alloc] initWithCapacity:2];
+	[cache setObject:@"1" forKey:@"a"];
+	[cache setObject:@"2" forKey:@"b"];
+	XCTAssertEqualObjects([cache objectForKey:@"a"], @"1");
+	[cache setObject:@"3" forKey:@"c"];
+	XCTAssertEqual(cache.count, 2);
+	XCTAssertEqualObjects([cache objectForKey:@"a"], @"1");
+	XCTAssertNil([cache objectForKey:@"b"]);
+	XCTAssertEqualObjects([cache objectForKey:@"c"], @"3");
+	XCTAssertEqual(cache.hitCount, 3);
+	XCTAssertEqual(cache.missCount, 1);
+}
+
+- (void)testReplacingObject {
+	SETOLRUCache *cache = [[SETOLRUCache alloc] initWithCapacity:2];
+	[cache setObject:@"1" forKey:@"a"];
+	[cache setObject:@"2" forKey:@"b"];
+	[cache setObject:@"3" forKey:@"a"];
+	[cache setObject:@"4" forKey:@"c"];
+	XCTAssertEqualObjects([cache objectForKey:@"a"], @"3");
+	XCTAssertNil([cache objectForKey:@"b"]);
+}
+
+- (void)testReducingCapacity {
+	SETOLRUCache *cache = [[SETOLRUCache alloc] initWithCapacity:3];
+	[cache setObject:@"1" forKey:@"a"];
+	[cache setObject:@"2" forKey:@"b"];
+	[cache setObject:@"3" forKey:@"c"];
+	cache.capacity = 1;
+	XCTAssertEqual(cache.count, 1);
+	XCTAssertEqualObjects([cache objectForKey:@"c"], @"3");
+	cache.capacity = 0;
+	XCTAssertEqual(cache.count, 0);
+	[cache setObject:@"1" forKey:@"a"];
+	XCTAssertNil([cache objectForKey:@"a"]);
+}
+
+- (void)testRemoveAllObjects {
+	SETOLRUCache *cache = [[SETOLRUCache alloc] initWithCapacity:2];
+	[cache setObject:@"1" forKey:@"a"];
+	XCTAssertEqualObjects([cache objectForKey:@"a"], @"1");
+	[cache removeAllObjects];
+	XCTAssertEqual(cache.count, 0);
+	XCTAssertNil([cache objectForKey:@"a"]);
+	[cache setObject:@"2" forKey:@"b"];
+	XCTAssertEqualObjects([cache objectForKey:@"b"], @"2");
+	XCTAssertEqual(cache.hitCount, 2);
+	XCTAssertEqual(cache.missCount, 1);
+}
+
+- (void)testRemoveObjectsPassingTest {
+	SETOLRUCache *cache = [[SETOLRUCache alloc] initWithCapacity:4];
+	[cache setObject:@"1" forKey:@"a"];
+	[cache setObject:@"2" forKey:@"b"];
+	[cache setObject:@"3" forKey:@"c"];
+	// the predicate may call back into the cache, entries replaced meanwhile are kept:
+	[cache removeObjectsPassingTest:^BOOL(NSString *key, NSString *object) {
+		if ([key isEqualToString:@"c"]) {
+			[cache setObject:@"4" forKey:@"c"];
+		}
+		return ![key isEqualToString:@"a"];
+	}];
+	XCTAssertEqual(cache.count, 2);
+	XCTAssertEqualObjects([cache objectForKey:@"a"], @"1");
+	XCTAssertNil([cache objectForKey:@"b"]);
+	XCTAssertEqualObjects([cache objectForKey:@"c"], @"4");
+}
+
+- (void)testConcurrentAccess {
+	SETOLRUCache *cache = [[SETOLRUCache alloc] initWithCapacity:64];
+	dispatch_apply(10000, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+		NSString *key = [NSString stringWithFormat:@"%zu", i % 128];
+		if (![cache objectForKey:key]) {
+			[cache setObject:key forKey:key];
+		}
+	});
+	XCTAssertEqual(cache.count, 64);
+	XCTAssertEqual(cache.hitCount + cache.missCount, 10000);
+}
+
+@end
@@ -9,6 +9,7 @@
 #import <XCTest/XCTest.h>
 #import "SETOMasterKeyFile.h"
 #import "SETOMasterKey.h"
+#import "SETOScryptContext.h"
 #import "SETOSecureRandomMock.h"
 
 // exposing some of SETOMasterKey's properties and methods for testability
@@ -16,11 +17,12 @@
 @property (nonatomic, readonly) NSData *scryptSalt;
 @property (nonatomic, readonly) uint64_t scryptCostParam;
 @property (nonatomic, readonly) uint32_t scryptBlockSize;
+@property (nonatomic, readonly) uint32_t scryptParallelization;
 @property (nonatomic, readonly) NSData *primaryMasterKey;
 @property (nonatomic, readonly) NSData *macMasterKey;
 @property (nonatomic, readonly) NSData *versionMac;
 
-+ (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam secureRandom:(SETOSecureRandom *)secureRandom error:(NSError **)error;
++ (NSData *)lockMasterKey:(SETOMasterKey *)masterKey withVaultVersion:(NSInteger)vaultVersion passphrase:(NSString *)passphrase pepper:(NSData *)pepper scryptCostParam:(uint64_t)scryptCostParam scryptParallelization:(uint32_t)scryptParallelization secureRandom:(SETOSecureRandom *)secureRandom error:(NSError **)error;
 + (NSData *)wrapKey:(NSData *)rawKey kek:(unsigned char *)kekBytes error:(NSError **)error;
 + (NSData *)unwrapKey:(NSData *)wrappedKey kek:(unsigned char *)kekBytes error:(NSError **)error;
 @end
@@ -37,6 +39,7 @@
 	XCTAssertEqualObjects([[NSData alloc] initWithBase64EncodedString:@"AAAAAAAAAAA=" options:0], masterKeyFile.scryptSalt);
 	XCTAssertEqual(2, masterKeyFile.scryptCostParam);
 	XCTAssertEqual(8, masterKeyFile.scryptBlockSize);
+	XCTAssertEqual(0, masterKeyFile.scryptParallelization);
 	XCTAssertEqualObjects([[NSData alloc] initWithBase64EncodedString:@"mM+qoQ+o0qvPTiDAZYt+flaC3WbpNAx1sTXaUzxwpy0M9Ctj6Tih/Q==" options:0], masterKeyFile.primaryMasterKey);
 	XCTAssertEqualObjects([[NSData alloc] initWithBase64EncodedString:@"mM+qoQ+o0qvPTiDAZYt+flaC3WbpNAx1sTXaUzxwpy0M9Ctj6Tih/Q==" options:0], masterKeyFile.macMasterKey);
 	XCTAssertEqualObjects([[NSData alloc] initWithBase64EncodedString:@"cn2sAK6l9p1/w9deJVUuW3h7br056mpv5srvALiYw+g=" options:0], masterKeyFile.versionMac);
@@ -54,6 +57,29 @@
 	XCTAssertEqualObjects([NSData dataWithBytes:expectedKeyBuffer length:sizeof(expectedKeyBuffer)], masterKey.macMasterKey);
 }
 
+- (void)testUnlockWithScryptContext {
+	NSData *jsonData1 = [@"{\"scryptSalt\":\"AAAAAAAAAAA=\",\"scryptCostParam\":2,\"scryptBlockSize\":8,\"primaryMasterKey\":\"mM+qoQ+o0qvPTiDAZYt+flaC3WbpNAx1sTXaUzxwpy0M9Ctj6Tih/Q==\",\"hmacMasterKey\":\"mM+qoQ+o0qvPTiDAZYt+flaC3WbpNAx1sTXaUzxwpy0M9Ctj6Tih/Q==\",\"versionMac\":\"cn2sAK6l9p1/w9deJVUuW3h7br056mpv5srvALiYw+g=\",\"version\":7}" dataUsingEncoding:NSUTF8StringEncoding];
+	NSData *jsonData2 = [@"{\"scryptSalt\":\"xjkJmSgJ/zU=\",\"scryptCostParam\":16384,\"scryptBlockSize\":8,\"primaryMasterKey\":\"3BvylqppBfNQ+ZJNS+wRbSKutuHT3AGGIY3IT0yMzpSSBfS+pr6WIw==\",\"hmacMasterKey\":\"pienjdRNu5PY4ZY8sM/CwGMZGVZ4YmO4MjXwSYYEaiy13/Qm0NoAcA==\",\"versionMac\":\"8ArW2fJ4Tdi0NjqNPw+QngU3YLX009G7ZplJi+7kQxo=\",\"version\":5}" dataUsingEncoding:NSUTF8StringEncoding];
+	SETOMasterKeyFile *masterKeyFile1 = [[SETOMasterKeyFile alloc] initWithContentFromJSONData:jsonData1];
+	SETOMasterKeyFile *masterKeyFile2 = [[SETOMasterKeyFile alloc] initWithContentFromJSONData:jsonData2];
+	SETOScryptContext *scryptContext = [[SETOScryptContext alloc] init];
+	XCTAssertNotNil(scryptContext);
+
+	// the context grows with the cost param and is reused afterwards:
+	for (SETOMasterKeyFile *masterKeyFile in @[masterKeyFile1, masterKeyFile2, masterKeyFile1, masterKeyFile2]) {
+		NSString *passphrase = masterKeyFile == masterKeyFile1 ? @"asd" : @"țț"; // NFC + NFD
+		NSError *unlockError;
+		SETOMasterKey *masterKey = [masterKeyFile unlockWithPassphrase:passphrase pepper:nil scryptContext:scryptContext error:&unlockError];
+		XCTAssertNotNil(masterKey);
+		XCTAssertNil(unlockError);
+		XCTAssertEqualObjects([masterKeyFile unlockWithPassphrase:passphrase pepper:nil error:NULL].aesMasterKey, masterKey.aesMasterKey);
+	}
+
+	NSError *unlockError;
+	XCTAssertNil([masterKeyFile1 unlockWithPassphrase:@"qwe" pepper:nil scryptContext:scryptContext error:&unlockError]);
+	XCTAssertEqual(SETOMasterKeyFileInvalidPassphraseError, unlockError.code);
+}
+
 - (void)testUnlockWithWrongPassphrase {
 	NSData *jsonData = [@"{\"scryptSalt\":\"AAAAAAAAAAA=\",\"scryptCostParam\":2,\"scryptBlockSize\":8,\"primaryMasterKey\":\"mM+qoQ+o0qvPTiDAZYt+flaC3WbpNAx1sTXaUzxwpy0M9Ctj6Tih/Q==\",\"hmacMasterKey\":\"mM+qoQ+o0qvPTiDAZYt+flaC3WbpNAx1sTXaUzxwpy0M9Ctj6Tih/Q==\",\"versionMac\":\"cn2sAK6l9p1/w9deJVUuW3h7br056mpv5srvALiYw+g=\",\"version\":7}" dataUsingEncoding:NSUTF8StringEncoding];
 	SETOMasterKeyFile *masterKeyFile = [[SETOMasterKeyFile alloc] initWithContentFromJSONData:jsonData];
@@ -135,7 +161,7 @@
 	NSData *macMasterKey = [NSData dataWithBytes:macMasterKeyBuffer length:sizeof(macMasterKeyBuffer)];
 	SETOMasterKey *masterKey = [[SETOMasterKey alloc] initWithAESMasterKey:aesMasterKey macMasterkey:macMasterKey];
 	NSError *lockError;
-	NSData *jsonData = [SETOMasterKeyFile lockMasterKey:masterKey withVaultVersion:7 passphrase:@"asd" pepper:nil scryptCostParam:2 secureRandom:[[SETOSecureRandomMock alloc] init] error:&lockError];
+	NSData *jsonData = [SETOMasterKeyFile lockMasterKey:masterKey withVaultVersion:7 passphrase:@"asd" pepper:nil scryptCostParam:2 scryptParallelization:1 secureRandom:[[SETOSecureRandomMock alloc] init] error:&lockError];
 	XCTAssertNotNil(jsonData);
 	XCTAssertNil(lockError);
 
@@ -147,6 +173,7 @@
 	XCTAssertEqualObjects(@"8PDw8PDw8PA=", jsonDict[@"scryptSalt"]);
 	XCTAssertEqual(2, [jsonDict[@"scryptCostParam"] integerValue]);
 	XCTAssertEqual(8, [jsonDict[@"scryptBlockSize"] integerValue]);
+	XCTAssertNil(jsonDict[@"scryptParallelization"]);
 	XCTAssertEqualObjects(@"jvdghkTc01VISrFly37pgaT/UKtXrDCvZcU3tT9Y98zyzn/pJ91bxw==", jsonDict[@"primaryMasterKey"]);
 	XCTAssertEqualObjects(@"99I+J4bT3rVpZE8yZwKRV9gHVRmQ8XQEujAL9IuwLTc2D3mg5JEjKA==", jsonDict[@"hmacMasterKey"]);
 	XCTAssertEqualObjects(@"sAWFgFNhmtMPeNWr4zh+9Ps7GOtT0pknX11PRQ7eC9Q=", jsonDict[@"versionMac"]);
@@ -169,6 +196,53 @@
 	XCTAssertNotEqualObjects(jsonData1, jsonData2);
 }
 
+- (void)testLockAndUnlockWithParallelization {
+	unsigned char aesMasterKeyBuffer[] = {[0 ... 31] = 0x55};
+	NSData *aesMasterKey = [NSData dataWithBytes:aesMasterKeyBuffer length:sizeof(aesMasterKeyBuffer)];
+	unsigned char macMasterKeyBuffer[] = {[0 ... 31] = 0x77};
+	NSData *macMasterKey = [NSData dataWithBytes:macMasterKeyBuffer length:sizeof(macMasterKeyBuffer)];
+	SETOMasterKey *masterKey = [[SETOMasterKey alloc] initWithAESMasterKey:aesMasterKey macMasterkey:macMasterKey];
+	NSError *lockError;
+	NSData *jsonData = [SETOMasterKeyFile lockMasterKey:masterKey withVaultVersion:7 passphrase:@"asd" pepper:nil scryptCostParam:2 scryptParallelization:4 secureRandom:[[SETOSecureRandomMock alloc] init] error:&lockError];
+	XCTAssertNotNil(jsonData);
+	XCTAssertNil(lockError);
+
+	NSDictionary *jsonDict = [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:NULL];
+	XCTAssertEqual(4, [jsonDict[@"scryptParallelization"] integerValue]);
+	XCTAssertNotEqualObjects(@"jvdghkTc01VISrFly37pgaT/UKtXrDCvZcU3tT9Y98zyzn/pJ91bxw==", jsonDict[@"primaryMasterKey"]);
+
+	SETOMasterKeyFile *masterKeyFile = [[SETOMasterKeyFile alloc] initWithContentFromJSONData:jsonData];
+	XCTAssertEqual(4, masterKeyFile.scryptParallelization);
+	NSError *unlockError;
+	SETOMasterKey *unlockedMasterKey = [masterKeyFile unlockWithPassphrase:@"asd" pepper:nil error:&unlockError];
+	XCTAssertNil(unlockError);
+	XCTAssertEqualObjects(aesMasterKey, unlockedMasterKey.aesMasterKey);
+	XCTAssertEqualObjects(macMasterKey, unlockedMasterKey.macMasterKey);
+}
+
+- (void)testScryptCalibration {
+	uint64_t memoryLimit = 128 * 1024 * 1024;
+	uint64_t costParam = [SETOMasterKeyFile calibratedScryptCostParamForDuration:0.25 memoryLimit:memoryLimit scryptParallelization:1];
+	XCTAssertGreaterThanOrEqual(costParam, kSETOMasterKeyFileDefaultScryptCostParam);
+	XCTAssertEqual(0, costParam & (costParam - 1));
+	XCTAssertLessThanOrEqual(costParam * 1024, memoryLimit);
+
+	uint64_t parallelCostParam = [SETOMasterKeyFile calibratedScryptCostParamForDuration:0.25 memoryLimit:memoryLimit scryptParallelization:4];
+	XCTAssertGreaterThanOrEqual(parallelCostParam, kSETOMasterKeyFileDefaultScryptCostParam);
+	XCTAssertLessThanOrEqual(parallelCostParam * 1024 * 4, memoryLimit);
+}
+
+- (void)testScryptCalibrationLowerBound {
+	// no key derivation fits into zero seconds:
+	uint64_t memoryLimit = 128 * 1024 * 1024;
+	XCTAssertEqual(kSETOMasterKeyFileDefaultScryptCostParam, [SETOMasterKeyFile calibratedScryptCostParamForDuration:0.0 memoryLimit:memoryLimit scryptParallelization:1]);
+}
+
+- (void)testScryptCalibrationWithoutFittingCostParam {
+	XCTAssertEqual(0, [SETOMasterKeyFile calibratedScryptCostParamForDuration:0.25 memoryLimit:1024 scryptParallelization:1]);
+	XCTAssertEqual(0, [SETOMasterKeyFile calibratedScryptCostParamForDuration:0.25 memoryLimit:kSETOMasterKeyFileDefaultScryptCostParam * 1024 - 1 scryptParallelization:1]);
+}
+
 - (void)testWrapAndUnwrapKey {
 	unsigned char keyBuffer[] = {[0 ... 31] = 0x77};
 	NSData *key = [NSData dataWithBytes:keyBuffer length:sizeof(keyBuffer)];
@@ -28,199 +28,210 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "insecure_memzero.h"
 #include "sha256.h"
-#include "sysendian.h"
 
-#include "crypto_scrypt.h"
-
-static void blkcpy(uint8_t *, uint8_t *, size_t);
-static void blkxor(uint8_t *, uint8_t *, size_t);
-static void salsa20_8(uint8_t[64]);
-static void blockmix_salsa8(uint8_t *, uint8_t *, size_t);
-static uint64_t integerify(uint8_t *, size_t);
-static void smix(uint8_t *, size_t, uint64_t, uint8_t *, uint8_t *);
+#include "crypto_scrypt_smix.h"
+#include "crypto_scrypt_smix_neon.h"
+#include "crypto_scrypt_smix_sse2.h"
 
-static void
-blkcpy(uint8_t * dest, uint8_t * src, size_t len)
-{
-	size_t i;
+#include "crypto_scrypt.h"
 
-	for (i = 0; i < len; i++)
-		dest[i] = src[i];
-}
+/* Smix function to use, selected on first use by selectsmix(). */
+static void (*smix_func)(uint8_t *, size_t, uint64_t, void *, void *) = NULL;
+static pthread_once_t smix_once = PTHREAD_ONCE_INIT;
+
+/* Test vector used to validate an optimized smix before it is used. */
+static const struct scrypt_test {
+	const char * passwd;
+	const char * salt;
+	uint64_t N;
+	uint32_t r;
+	uint32_t p;
+	uint8_t result[64];
+} testcase = {
+	.passwd = "pleaseletmein",
+	.salt = "SodiumChloride",
+	.N = 16,
+	.r = 8,
+	.p = 1,
+	.result = {
+		0x25, 0xa9, 0xfa, 0x20, 0x7f, 0x87, 0xca, 0x09,
+		0xa4, 0xef, 0x8b, 0x9f, 0x77, 0x7a, 0xca, 0x16,
+		0xbe, 0xb7, 0x84, 0xae, 0x18, 0x30, 0xbf, 0xbf,
+		0xd3, 0x83, 0x25, 0xaa, 0xbb, 0x93, 0x77, 0xdf,
+		0x1b, 0xa7, 0x84, 0xd7, 0x46, 0xea, 0x27, 0x3b,
+		0xf5, 0x16, 0xa4, 0x6f, 0xbf, 0xac, 0xf5, 0x11,
+		0xc5, 0xbe, 0xba, 0x4c, 0x4a, 0xb3, 0xac, 0xc7,
+		0xfa, 0x6f, 0x46, 0x0b, 0x6c, 0x0f, 0x47, 0x7b
+	}
+};
 
-static void
-blkxor(uint8_t * dest, uint8_t * src, size_t len)
-{
-	size_t i;
+/**
+ * Maximum number of threads used to compute independent smix lanes.  Each
+ * thread uses its own 128rN bytes of scratch space.
+ */
+#define CRYPTO_SCRYPT_MAX_THREADS 8
 
-	for (i = 0; i < len; i++)
-		dest[i] ^= src[i];
-}
+/* Working memory kept across computations, see crypto_scrypt_ctx_init(). */
+struct crypto_scrypt_ctx {
+	pthread_mutex_t mutex;
+	uint8_t * B;
+	size_t Blen;
+	uint8_t * scratch[CRYPTO_SCRYPT_MAX_THREADS];
+	size_t scratchlen[CRYPTO_SCRYPT_MAX_THREADS];
+};
+
+/* Lanes of B computed by one thread. */
+struct smix_lanes {
+	pthread_t thread;
+	uint8_t * B;
+	size_t r;
+	uint64_t N;
+	uint32_t first;
+	uint32_t stride;
+	uint32_t p;
+	uint8_t * scratch;
+	void (*smix)(uint8_t *, size_t, uint64_t, void *, void *);
+	int rc;
+	int err;
+};
 
 /**
- * salsa20_8(B):
- * Apply the salsa20/8 core to the provided block.
+ * smix_lanes(cookie):
+ * Compute B_i <-- MF(B_i, N) for the lanes first, first + stride, ... of the
+ * provided smix_lanes structure.  The scratch space is taken from scratch
+ * if it is not NULL, which must then hold 256r + 64 + 128rN bytes; or
+ * allocated privately otherwise.  Store 0 in rc on success; or -1 in rc and
+ * the error number in err on failure.
  */
-static void
-salsa20_8(uint8_t B[64])
+static void *
+smix_lanes(void * cookie)
 {
-	uint32_t B32[16];
-	uint32_t x[16];
-	size_t i;
-
-	/* Convert little-endian values in. */
-	for (i = 0; i < 16; i++)
-		B32[i] = le32dec(&B[i * 4]);
-
-	/* Compute x = doubleround^4(B32). */
-	for (i = 0; i < 16; i++)
-		x[i] = B32[i];
-	for (i = 0; i < 8; i += 2) {
-#define R(a,b) (((a) << (b)) | ((a) >> (32 - (b))))
-		/* Operate on columns. */
-		x[ 4] ^= R(x[ 0]+x[12], 7);  x[ 8] ^= R(x[ 4]+x[ 0], 9);
-		x[12] ^= R(x[ 8]+x[ 4],13);  x[ 0] ^= R(x[12]+x[ 8],18);
-
-		x[ 9] ^= R(x[ 5]+x[ 1], 7);  x[13] ^= R(x[ 9]+x[ 5], 9);
-		x[ 1] ^= R(x[13]+x[ 9],13);  x[ 5] ^= R(x[ 1]+x[13],18);
-
-		x[14] ^= R(x[10]+x[ 6], 7);  x[ 2] ^= R(x[14]+x[10], 9);
-		x[ 6] ^= R(x[ 2]+x[14],13);  x[10] ^= R(x[ 6]+x[ 2],18);
-
-		x[ 3] ^= R(x[15]+x[11], 7);  x[ 7] ^= R(x[ 3]+x[15], 9);
-		x[11] ^= R(x[ 7]+x[ 3],13);  x[15] ^= R(x[11]+x[ 7],18);
-
-		/* Operate on rows. */
-		x[ 1] ^= R(x[ 0]+x[ 3], 7);  x[ 2] ^= R(x[ 1]+x[ 0], 9);
-		x[ 3] ^= R(x[ 2]+x[ 1],13);  x[ 0] ^= R(x[ 3]+x[ 2],18);
+	struct smix_lanes * L = cookie;
+	void * V0, * XY0;
+	size_t r = L->r;
+	uint32_t i;
 
-		x[ 6] ^= R(x[ 5]+x[ 4], 7);  x[ 7] ^= R(x[ 6]+x[ 5], 9);
-		x[ 4] ^= R(x[ 7]+x[ 6],13);  x[ 5] ^= R(x[ 4]+x[ 7],18);
+	/* Use the provided scratch space, XY followed by V. */
+	if (L->scratch != NULL) {
+		for (i = L->first; i < L->p; i += L->stride) {
+			(L->smix)(&L->B[i * 128 * r], r, L->N,
+			    &L->scratch[256 * r + 64], L->scratch);
+		}
+		L->rc = 0;
+		return (NULL);
+	}
 
-		x[11] ^= R(x[10]+x[ 9], 7);  x[ 8] ^= R(x[11]+x[10], 9);
-		x[ 9] ^= R(x[ 8]+x[11],13);  x[10] ^= R(x[ 9]+x[ 8],18);
+	/* Allocate memory, aligned to cache lines for the vectorized smix. */
+	if ((L->err = posix_memalign(&XY0, 64, 256 * r + 64)) != 0)
+		goto err0;
+	if ((L->err = posix_memalign(&V0, 64, (size_t)(128 * r * L->N))) != 0)
+		goto err1;
 
-		x[12] ^= R(x[15]+x[14], 7);  x[13] ^= R(x[12]+x[15], 9);
-		x[14] ^= R(x[13]+x[12],13);  x[15] ^= R(x[14]+x[13],18);
-#undef R
+	/* 2: for i = 0 to p - 1 do */
+	for (i = L->first; i < L->p; i += L->stride) {
+		/* 3: B_i <-- MF(B_i, N) */
+		(L->smix)(&L->B[i * 128 * r], r, L->N, V0, XY0);
 	}
 
-	/* Compute B32 = B32 + x. */
-	for (i = 0; i < 16; i++)
-		B32[i] += x[i];
+	/* Free memory. */
+	free(V0);
+	free(XY0);
+
+	/* Success! */
+	L->rc = 0;
+	return (NULL);
 
-	/* Convert little-endian values out. */
-	for (i = 0; i < 16; i++)
-		le32enc(&B[4 * i], B32[i]);
+err1:
+	free(XY0);
+err0:
+	/* Failure! */
+	L->rc = -1;
+	return (NULL);
 }
 
 /**
- * blockmix_salsa8(B, Y, r):
- * Compute B = BlockMix_{salsa20/8, r}(B).  The input B must be 128r bytes in
- * length; the temporary space Y must also be the same size.
+ * ctx_reserve(buf, buflen, len):
+ * Make sure that ${buf} points to at least ${len} bytes of memory aligned to
+ * a multiple of 64 bytes, replacing a smaller buffer of ${buflen} bytes.  New
+ * memory is written once, so its pages are faulted in before it is used.
+ *
+ * Return 0 on success; or -1 on error.
  */
-static void
-blockmix_salsa8(uint8_t * B, uint8_t * Y, size_t r)
+static int
+ctx_reserve(uint8_t ** buf, size_t * buflen, size_t len)
 {
-	uint8_t X[64];
-	size_t i;
-
-	/* 1: X <-- B_{2r - 1} */
-	blkcpy(X, &B[(2 * r - 1) * 64], 64);
-
-	/* 2: for i = 0 to 2r - 1 do */
-	for (i = 0; i < 2 * r; i++) {
-		/* 3: X <-- H(X \xor B_i) */
-		blkxor(X, &B[i * 64], 64);
-		salsa20_8(X);
+	void * p;
 
-		/* 4: Y_i <-- X */
-		blkcpy(&Y[i * 64], X, 64);
-	}
+	/* Keep the buffer if it is large enough. */
+	if (*buflen >= len)
+		return (0);
 
-	/* 6: B' <-- (Y_0, Y_2 ... Y_{2r-2}, Y_1, Y_3 ... Y_{2r-1}) */
-	for (i = 0; i < r; i++)
-		blkcpy(&B[i * 64], &Y[(i * 2) * 64], 64);
-	for (i = 0; i < r; i++)
-		blkcpy(&B[(i + r) * 64], &Y[(i * 2 + 1) * 64], 64);
-}
+	/* Replace the buffer. */
+	if ((errno = posix_memalign(&p, 64, len)) != 0)
+		return (-1);
+	free(*buf);
+	*buf = p;
+	*buflen = len;
 
-/**
- * integerify(B, r):
- * Return the result of parsing B_{2r-1} as a little-endian integer.
- */
-static uint64_t
-integerify(uint8_t * B, size_t r)
-{
-	uint8_t * X = &B[(2 * r - 1) * 64];
+	/* Pre-fault the pages. */
+	memset(*buf, 0, len);
 
-	return (le64dec(X));
+	/* Success! */
+	return (0);
 }
 
 /**
- * smix(B, r, N, V, XY):
- * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length; the
- * temporary storage V must be 128rN bytes in length; the temporary storage
- * XY must be 256r bytes in length.  The value N must be a power of 2.
+ * ctx_zero(ctx, nthreads, r, p, N):
+ * Zero the parts of ${ctx}'s working memory which have been used by a
+ * computation with the given parameters.  This keeps the pages resident for
+ * the next computation.
  */
 static void
-smix(uint8_t * B, size_t r, uint64_t N, uint8_t * V, uint8_t * XY)
+ctx_zero(struct crypto_scrypt_ctx * ctx, uint32_t nthreads, size_t r,
+    size_t p, uint64_t N)
 {
-	uint8_t * X = XY;
-	uint8_t * Y = &XY[128 * r];
-	uint64_t i;
-	uint64_t j;
-
-	/* 1: X <-- B */
-	blkcpy(X, B, 128 * r);
-
-	/* 2: for i = 0 to N - 1 do */
-	for (i = 0; i < N; i++) {
-		/* 3: V_i <-- X */
-		blkcpy(&V[i * (128 * r)], X, 128 * r);
-
-		/* 4: X <-- H(X) */
-		blockmix_salsa8(X, Y, r);
-	}
-
-	/* 6: for i = 0 to N - 1 do */
-	for (i = 0; i < N; i++) {
-		/* 7: j <-- Integerify(X) mod N */
-		j = integerify(X, r) & (N - 1);
+	size_t len = 256 * r + 64 + (size_t)(128 * r * N);
+	uint32_t i;
 
-		/* 8: X <-- H(X \xor V_j) */
-		blkxor(X, &V[j * (128 * r)], 128 * r);
-		blockmix_salsa8(X, Y, r);
+	if (ctx->Blen >= 128 * r * p)
+		insecure_memzero(ctx->B, 128 * r * p);
+	for (i = 0; i < nthreads; i++) {
+		if (ctx->scratchlen[i] >= len)
+			insecure_memzero(ctx->scratch[i], len);
 	}
-
-	/* 10: B' <-- X */
-	blkcpy(B, X, 128 * r);
 }
 
 /**
- * crypto_scrypt(passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
- * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
- * p, buflen) and write the result into buf.  The parameters r, p, and buflen
- * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
- * must be a power of 2.
- *
- * Return 0 on success; or -1 on error.
+ * crypto_scrypt_internal(passwd, passwdlen, salt, saltlen, N, r, p, buf,
+ *     buflen, smix, ctx):
+ * Perform the requested scrypt computation, using ${smix} as the smix
+ * routine.  If p > 1, the independent lanes are spread over up to
+ * CRYPTO_SCRYPT_MAX_THREADS threads.  If ${ctx} is not NULL, its working
+ * memory is used and zeroed afterwards; the caller must hold its mutex.
  */
-int
-crypto_scrypt(const uint8_t * passwd, size_t passwdlen,
+static int
+crypto_scrypt_internal(const uint8_t * passwd, size_t passwdlen,
     const uint8_t * salt, size_t saltlen, uint64_t N, uint32_t _r, uint32_t _p,
-    uint8_t * buf, size_t buflen)
+    uint8_t * buf, size_t buflen,
+    void (*smix)(uint8_t *, size_t, uint64_t, void *, void *),
+    struct crypto_scrypt_ctx * ctx)
 {
+	struct smix_lanes lanes[CRYPTO_SCRYPT_MAX_THREADS];
+	int started[CRYPTO_SCRYPT_MAX_THREADS];
+	void * B0;
 	uint8_t * B;
-	uint8_t * V;
-	uint8_t * XY;
 	size_t r = _r, p = _p;
+	uint32_t nthreads;
 	uint32_t i;
+	long ncpu;
 
 	/* Sanity-check parameters. */
 #if SIZE_MAX > UINT32_MAX
@@ -233,52 +244,258 @@ crypto_scrypt(const uint8_t * passwd, size_t passwdlen,
 		errno = EFBIG;
 		goto err0;
 	}
-	if (((N & (N - 1)) != 0) || (N == 0)) {
+	if (((N & (N - 1)) != 0) || (N < 2)) {
 		errno = EINVAL;
 		goto err0;
 	}
 	if ((r > SIZE_MAX / 128 / p) ||
 #if SIZE_MAX / 256 <= UINT32_MAX
-	    (r > SIZE_MAX / 256) ||
+	    (r > (SIZE_MAX - 64) / 256) ||
 #endif
-	    (N > SIZE_MAX / 128 / r)) {
+	    (N > SIZE_MAX / 128 / r) ||
+	    ((ctx != NULL) && (128 * r * N > SIZE_MAX - 256 * r - 64))) {
 		errno = ENOMEM;
 		goto err0;
 	}
 
-	/* Allocate memory. */
-	if ((B = malloc(128 * r * p)) == NULL)
-		goto err0;
-	if ((XY = malloc(256 * r)) == NULL)
-		goto err1;
-	if ((V = malloc(128 * r * N)) == NULL)
-		goto err2;
+	/* Allocate memory, or take it from the context. */
+	if (ctx != NULL) {
+		if (ctx_reserve(&ctx->B, &ctx->Blen, 128 * r * p))
+			goto err0;
+		B0 = NULL;
+		B = ctx->B;
+	} else {
+		if ((errno = posix_memalign(&B0, 64, 128 * r * p)) != 0)
+			goto err0;
+		B = (uint8_t *)(B0);
+	}
 
 	/* 1: (B_0 ... B_{p-1}) <-- PBKDF2(P, S, 1, p * MFLen) */
 	PBKDF2_SHA256(passwd, passwdlen, salt, saltlen, 1, B, p * 128 * r);
 
-	/* 2: for i = 0 to p - 1 do */
-	for (i = 0; i < p; i++) {
-		/* 3: B_i <-- MF(B_i, N) */
-		smix(&B[i * 128 * r], r, N, V, XY);
+	/* Use one thread per lane, limited by the number of CPUs. */
+	nthreads = (uint32_t)p;
+	if ((ncpu = sysconf(_SC_NPROCESSORS_ONLN)) > 0 &&
+	    (uint64_t)(ncpu) < nthreads)
+		nthreads = (uint32_t)ncpu;
+	if (nthreads > CRYPTO_SCRYPT_MAX_THREADS)
+		nthreads = CRYPTO_SCRYPT_MAX_THREADS;
+	for (i = 0; i < nthreads; i++) {
+		lanes[i].B = B;
+		lanes[i].r = r;
+		lanes[i].N = N;
+		lanes[i].first = i;
+		lanes[i].stride = nthreads;
+		lanes[i].p = (uint32_t)p;
+		lanes[i].scratch = NULL;
+		lanes[i].smix = smix;
+		lanes[i].rc = -1;
+		lanes[i].err = 0;
+		if (ctx != NULL) {
+			if (ctx_reserve(&ctx->scratch[i], &ctx->scratchlen[i],
+			    256 * r + 64 + (size_t)(128 * r * N)))
+				goto err1;
+			lanes[i].scratch = ctx->scratch[i];
+		}
+	}
+
+	/*
+	 * Lanes write to disjoint parts of B.  The calling thread computes the
+	 * first set of lanes, as well as those which a thread could not be
+	 * started for.
+	 */
+	started[0] = 0;
+	for (i = 1; i < nthreads; i++)
+		started[i] = (pthread_create(&lanes[i].thread, NULL,
+		    smix_lanes, &lanes[i]) == 0);
+	for (i = 0; i < nthreads; i++) {
+		if (!started[i])
+			smix_lanes(&lanes[i]);
+	}
+	for (i = 1; i < nthreads; i++) {
+		if (started[i])
+			pthread_join(lanes[i].thread, NULL);
+	}
+	for (i = 0; i < nthreads; i++) {
+		if (lanes[i].rc) {
+			errno = lanes[i].err;
+			goto err1;
+		}
 	}
 
 	/* 5: DK <-- PBKDF2(P, B, 1, dkLen) */
 	PBKDF2_SHA256(passwd, passwdlen, B, p * 128 * r, 1, buf, buflen);
 
-	/* Free memory. */
-	free(V);
-	free(XY);
-	free(B);
+	/* Zero the context's memory, or free memory. */
+	if (ctx != NULL)
+		ctx_zero(ctx, nthreads, r, p, N);
+	free(B0);
 
 	/* Success! */
 	return (0);
 
-err2:
-	free(XY);
 err1:
-	free(B);
+	if (ctx != NULL)
+		ctx_zero(ctx, nthreads, r, p, N);
+	free(B0);
 err0:
 	/* Failure! */
 	return (-1);
 }
+
+/**
+ * testsmix(smix):
+ * Return 0 if ${smix} computes the test vector correctly; or -1 otherwise.
+ */
+static int
+testsmix(void (*smix)(uint8_t *, size_t, uint64_t, void *, void *))
+{
+	uint8_t hbuf[64];
+
+	/* Perform the computation. */
+	if (crypto_scrypt_internal(
+	    (const uint8_t *)testcase.passwd, strlen(testcase.passwd),
+	    (const uint8_t *)testcase.salt, strlen(testcase.salt),
+	    testcase.N, testcase.r, testcase.p, hbuf, 64, smix, NULL))
+		return (-1);
+
+	/* Does it match? */
+	return (memcmp(testcase.result, hbuf, 64) ? -1 : 0);
+}
+
+/**
+ * selectsmix(void):
+ * Pick the fastest smix which the compiler targets and which computes the
+ * test vector correctly, falling back to the generic implementation.
+ */
+static void
+selectsmix(void)
+{
+
+#ifdef CRYPTO_SCRYPT_SMIX_NEON_AVAILABLE
+	/* NEON is part of every arm64 CPU. */
+	if (!testsmix(crypto_scrypt_smix_neon)) {
+		smix_func = crypto_scrypt_smix_neon;
+		return;
+	}
+#endif
+#ifdef CRYPTO_SCRYPT_SMIX_SSE2_AVAILABLE
+	/* SSE2 is part of every x86_64 CPU. */
+	if (!testsmix(crypto_scrypt_smix_sse2)) {
+		smix_func = crypto_scrypt_smix_sse2;
+		return;
+	}
+#endif
+
+	/* Use the generic smix. */
+	smix_func = crypto_scrypt_smix;
+}
+
+/**
+ * crypto_scrypt(passwd, passwdlen, salt, saltlen, N, r, p, buf, buflen):
+ * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
+ * p, buflen) and write the result into buf.  The parameters r, p, and buflen
+ * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
+ * must be a power of 2 greater than 1.  If p > 1, the independent lanes are
+ * computed in parallel on multiple threads, each of which allocates 128rN
+ * bytes of scratch space.
+ *
+ * Return 0 on success; or -1 on error.
+ */
+int
+crypto_scrypt(const uint8_t * passwd, size_t passwdlen,
+    const uint8_t * salt, size_t saltlen, uint64_t N, uint32_t _r, uint32_t _p,
+    uint8_t * buf, size_t buflen)
+{
+
+	/* Pick the smix on first use. */
+	if (pthread_once(&smix_once, selectsmix))
+		return (-1);
+
+	return (crypto_scrypt_internal(passwd, passwdlen, salt, saltlen, N,
+	    _r, _p, buf, buflen, smix_func, NULL));
+}
+
+/**
+ * crypto_scrypt_ctx_init(void):
+ * Create a context which keeps the working memory of crypto_scrypt_ctx()
+ * across computations.
+ *
+ * Return the context on success; or NULL on error.
+ */
+struct crypto_scrypt_ctx *
+crypto_scrypt_ctx_init(void)
+{
+	struct crypto_scrypt_ctx * ctx;
+
+	/* Allocate structure. */
+	if ((ctx = calloc(1, sizeof(struct crypto_scrypt_ctx))) == NULL)
+		goto err0;
+
+	/* Initialize mutex. */
+	if ((errno = pthread_mutex_init(&ctx->mutex, NULL)) != 0)
+		goto err1;
+
+	/* Success! */
+	return (ctx);
+
+err1:
+	free(ctx);
+err0:
+	/* Failure! */
+	return (NULL);
+}
+
+/**
+ * crypto_scrypt_ctx(ctx, passwd, passwdlen, salt, saltlen, N, r, p, buf,
+ *     buflen):
+ * Compute scrypt like crypto_scrypt(), but use the working memory kept by
+ * ${ctx}.  The memory is allocated and pre-faulted on first use, grown if
+ * later computations need more of it, and zeroed after each computation.
+ * Concurrent computations using the same context are serialized.
+ *
+ * Return 0 on success; or -1 on error.
+ */
+int
+crypto_scrypt_ctx(struct crypto_scrypt_ctx * ctx, const uint8_t * passwd,
+    size_t passwdlen, const uint8_t * salt, size_t saltlen, uint64_t N,
+    uint32_t _r, uint32_t _p, uint8_t * buf, size_t buflen)
+{
+	int rc;
+
+	/* Pick the smix on first use. */
+	if (pthread_once(&smix_once, selectsmix))
+		return (-1);
+
+	/* Compute while holding the context. */
+	if ((errno = pthread_mutex_lock(&ctx->mutex)) != 0)
+		return (-1);
+	rc = crypto_scrypt_internal(passwd, passwdlen, salt, saltlen, N,
+	    _r, _p, buf, buflen, smix_func, ctx);
+	pthread_mutex_unlock(&ctx->mutex);
+
+	return (rc);
+}
+
+/**
+ * crypto_scrypt_ctx_free(ctx):
+ * Free the context ${ctx} and its working memory.
+ */
+void
+crypto_scrypt_ctx_free(struct crypto_scrypt_ctx * ctx)
+{
+	size_t i;
+
+	/* Behave consistently with free(NULL). */
+	if (ctx == NULL)
+		return;
+
+	/* Free working memory, which has been zeroed after its last use. */
+	free(ctx->B);
+	for (i = 0; i < CRYPTO_SCRYPT_MAX_THREADS; i++)
+		free(ctx->scratch[i]);
+
+	/* Free structure. */
+	pthread_mutex_destroy(&ctx->mutex);
+	free(ctx);
+}
@@ -38,11 +38,44 @@
  * Compute scrypt(passwd[0 .. passwdlen - 1], salt[0 .. saltlen - 1], N, r,
  * p, buflen) and write the result into buf.  The parameters r, p, and buflen
  * must satisfy r * p < 2^30 and buflen <= (2^32 - 1) * 32.  The parameter N
- * must be a power of 2 greater than 1.
+ * must be a power of 2 greater than 1.  If p > 1, the independent lanes are
+ * computed in parallel on multiple threads, each of which allocates 128rN
+ * bytes of scratch space.
  *
  * Return 0 on success; or -1 on error.
  */
 int crypto_scrypt(const uint8_t *, size_t, const uint8_t *, size_t, uint64_t,
     uint32_t, uint32_t, uint8_t *, size_t);
 
+/* Opaque context which keeps scrypt's working memory across computations. */
+struct crypto_scrypt_ctx;
+
+/**
+ * crypto_scrypt_ctx_init(void):
+ * Create a context which keeps the working memory of crypto_scrypt_ctx()
+ * across computations.
+ *
+ * Return the context on success; or NULL on error.
+ */
+struct crypto_scrypt_ctx * crypto_scrypt_ctx_init(void);
+
+/**
+ * crypto_scrypt_ctx(ctx, passwd, passwdlen, salt, saltlen, N, r, p, buf,
+ *     buflen):
+ * Compute scrypt like crypto_scrypt(), but use the working memory kept by
+ * ${ctx}.  The memory is allocated and pre-faulted on first use, grown if
+ * later computations need more of it, and zeroed after each computation.
+ * Concurrent computations using the same context are serialized.
+ *
+ * Return 0 on success; or -1 on error.
+ */
+int crypto_scrypt_ctx(struct crypto_scrypt_ctx *, const uint8_t *, size_t,
+    const uint8_t *, size_t, uint64_t, uint32_t, uint32_t, uint8_t *, size_t);
+
+/**
+ * crypto_scrypt_ctx_free(ctx):
+ * Free the context ${ctx} and its working memory.
+ */
+void crypto_scrypt_ctx_free(struct crypto_scrypt_ctx *);
+
 #endif /* !_CRYPTO_SCRYPT_H_ */
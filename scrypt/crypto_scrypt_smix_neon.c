@@ -0,0 +1,237 @@
+/*-
+ * Copyright 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "crypto_scrypt_smix_neon.h"
+
+#ifdef CRYPTO_SCRYPT_SMIX_NEON_AVAILABLE
+
+#include <arm_neon.h>
+#include <stdint.h>
+
+#include "sysendian.h"
+
+static void blkcpy(uint32x4_t *, const uint32x4_t *, size_t);
+static void blkxor(uint32x4_t *, const uint32x4_t *, size_t);
+static void salsa20_8(uint32x4_t[4]);
+static void blockmix_salsa8(const uint32x4_t *, uint32x4_t *, uint32x4_t *, size_t);
+static uint64_t integerify(const void *, size_t);
+
+static void
+blkcpy(uint32x4_t * dest, const uint32x4_t * src, size_t len)
+{
+	size_t L = len / 16;
+	size_t i;
+
+	for (i = 0; i < L; i++)
+		dest[i] = src[i];
+}
+
+static void
+blkxor(uint32x4_t * dest, const uint32x4_t * src, size_t len)
+{
+	size_t L = len / 16;
+	size_t i;
+
+	for (i = 0; i < L; i++)
+		dest[i] = veorq_u32(dest[i], src[i]);
+}
+
+/**
+ * salsa20_8(B):
+ * Apply the salsa20/8 core to the provided block.  The block is stored in
+ * the shuffled layout, i.e., B[i] holds the diagonal (x[i], x[i + 5],
+ * x[i + 10], x[i + 15]) with indices taken modulo 16.  Rotations are
+ * computed with a shift followed by a shift-right-and-insert.
+ */
+static void
+salsa20_8(uint32x4_t B[4])
+{
+	uint32x4_t X0, X1, X2, X3;
+	uint32x4_t T;
+	size_t i;
+
+	X0 = B[0];
+	X1 = B[1];
+	X2 = B[2];
+	X3 = B[3];
+
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on "columns". */
+		T = vaddq_u32(X0, X3);
+		X1 = veorq_u32(X1, vsriq_n_u32(vshlq_n_u32(T, 7), T, 25));
+		T = vaddq_u32(X1, X0);
+		X2 = veorq_u32(X2, vsriq_n_u32(vshlq_n_u32(T, 9), T, 23));
+		T = vaddq_u32(X2, X1);
+		X3 = veorq_u32(X3, vsriq_n_u32(vshlq_n_u32(T, 13), T, 19));
+		T = vaddq_u32(X3, X2);
+		X0 = veorq_u32(X0, vsriq_n_u32(vshlq_n_u32(T, 18), T, 14));
+
+		/* Rearrange data. */
+		X1 = vextq_u32(X1, X1, 3);
+		X2 = vextq_u32(X2, X2, 2);
+		X3 = vextq_u32(X3, X3, 1);
+
+		/* Operate on "rows". */
+		T = vaddq_u32(X0, X1);
+		X3 = veorq_u32(X3, vsriq_n_u32(vshlq_n_u32(T, 7), T, 25));
+		T = vaddq_u32(X3, X0);
+		X2 = veorq_u32(X2, vsriq_n_u32(vshlq_n_u32(T, 9), T, 23));
+		T = vaddq_u32(X2, X3);
+		X1 = veorq_u32(X1, vsriq_n_u32(vshlq_n_u32(T, 13), T, 19));
+		T = vaddq_u32(X1, X2);
+		X0 = veorq_u32(X0, vsriq_n_u32(vshlq_n_u32(T, 18), T, 14));
+
+		/* Rearrange data. */
+		X1 = vextq_u32(X1, X1, 1);
+		X2 = vextq_u32(X2, X2, 2);
+		X3 = vextq_u32(X3, X3, 3);
+	}
+
+	B[0] = vaddq_u32(B[0], X0);
+	B[1] = vaddq_u32(B[1], X1);
+	B[2] = vaddq_u32(B[2], X2);
+	B[3] = vaddq_u32(B[3], X3);
+}
+
+/**
+ * blockmix_salsa8(Bin, Bout, X, r):
+ * Compute Bout = BlockMix_{salsa20/8, r}(Bin).  The input Bin must be 128r
+ * bytes in length; the output Bout must also be the same size.  The
+ * temporary space X must be 64 bytes.
+ */
+static void
+blockmix_salsa8(const uint32x4_t * Bin, uint32x4_t * Bout, uint32x4_t * X, size_t r)
+{
+	size_t i;
+
+	/* 1: X <-- B_{2r - 1} */
+	blkcpy(X, &Bin[8 * r - 4], 64);
+
+	/* 2: for i = 0 to 2r - 1 do */
+	for (i = 0; i < r; i++) {
+		/* 3: X <-- H(X \xor B_i) */
+		blkxor(X, &Bin[i * 8], 64);
+		salsa20_8(X);
+
+		/* 4: Y_i <-- X */
+		/* 6: B' <-- (Y_0, Y_2 ... Y_{2r-2}, Y_1, Y_3 ... Y_{2r-1}) */
+		blkcpy(&Bout[i * 4], X, 64);
+
+		/* 3: X <-- H(X \xor B_i) */
+		blkxor(X, &Bin[i * 8 + 4], 64);
+		salsa20_8(X);
+
+		/* 4: Y_i <-- X */
+		/* 6: B' <-- (Y_0, Y_2 ... Y_{2r-2}, Y_1, Y_3 ... Y_{2r-1}) */
+		blkcpy(&Bout[(r + i) * 4], X, 64);
+	}
+}
+
+/**
+ * integerify(B, r):
+ * Return the result of parsing B_{2r-1} as a little-endian integer.  Note
+ * that B's layout is permuted compared to the generic implementation, so
+ * the second word of the block is found at position 13.
+ */
+static uint64_t
+integerify(const void * B, size_t r)
+{
+	const uint32_t * X = (const void *)((uintptr_t)(B) + (2 * r - 1) * 64);
+
+	return (((uint64_t)(X[13]) << 32) + X[0]);
+}
+
+/**
+ * crypto_scrypt_smix_neon(B, r, N, V, XY):
+ * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length; the
+ * temporary storage V must be 128rN bytes in length; the temporary storage
+ * XY must be 256r + 64 bytes in length.  The value N must be even and no
+ * smaller than 2.  The arrays V and XY must be aligned to a multiple of 64
+ * bytes.
+ *
+ * Use the NEON instruction set.
+ */
+void
+crypto_scrypt_smix_neon(uint8_t * B, size_t r, uint64_t N, void * V, void * XY)
+{
+	uint32x4_t * X = XY;
+	uint32x4_t * Y = (void *)((uintptr_t)(XY) + 128 * r);
+	uint32x4_t * Z = (void *)((uintptr_t)(XY) + 256 * r);
+	uint32_t * X32 = (void *)X;
+	uint64_t i, j;
+	size_t k;
+
+	/* 1: X <-- B, stored in the shuffled layout */
+	for (k = 0; k < 2 * r; k++) {
+		for (i = 0; i < 16; i++) {
+			X32[k * 16 + i] =
+			    le32dec(&B[(k * 16 + (i * 5 % 16)) * 4]);
+		}
+	}
+
+	/* 2: for i = 0 to N - 1 do */
+	for (i = 0; i < N; i += 2) {
+		/* 3: V_i <-- X */
+		blkcpy((void *)((uintptr_t)(V) + i * 128 * r), X, 128 * r);
+
+		/* 4: X <-- H(X) */
+		blockmix_salsa8(X, Y, Z, r);
+
+		/* 3: V_i <-- X */
+		blkcpy((void *)((uintptr_t)(V) + (i + 1) * 128 * r),
+		    Y, 128 * r);
+
+		/* 4: X <-- H(X) */
+		blockmix_salsa8(Y, X, Z, r);
+	}
+
+	/* 6: for i = 0 to N - 1 do */
+	for (i = 0; i < N; i += 2) {
+		/* 7: j <-- Integerify(X) mod N */
+		j = integerify(X, r) & (N - 1);
+
+		/* 8: X <-- H(X \xor V_j) */
+		blkxor(X, (void *)((uintptr_t)(V) + j * 128 * r), 128 * r);
+		blockmix_salsa8(X, Y, Z, r);
+
+		/* 7: j <-- Integerify(X) mod N */
+		j = integerify(Y, r) & (N - 1);
+
+		/* 8: X <-- H(X \xor V_j) */
+		blkxor(Y, (void *)((uintptr_t)(V) + j * 128 * r), 128 * r);
+		blockmix_salsa8(Y, X, Z, r);
+	}
+
+	/* 10: B' <-- X, restored from the shuffled layout */
+	for (k = 0; k < 2 * r; k++) {
+		for (i = 0; i < 16; i++) {
+			le32enc(&B[(k * 16 + (i * 5 % 16)) * 4],
+			    X32[k * 16 + i]);
+		}
+	}
+}
+
+#endif /* CRYPTO_SCRYPT_SMIX_NEON_AVAILABLE */
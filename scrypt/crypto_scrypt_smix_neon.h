@@ -0,0 +1,49 @@
+/*-
+ * Copyright 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _CRYPTO_SCRYPT_SMIX_NEON_H_
+#define _CRYPTO_SCRYPT_SMIX_NEON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * crypto_scrypt_smix_neon(B, r, N, V, XY):
+ * Compute B = SMix_r(B, N).  The input B must be 128r bytes in length; the
+ * temporary storage V must be 128rN bytes in length; the temporary storage
+ * XY must be 256r + 64 bytes in length.  The value N must be even and no
+ * smaller than 2.  The arrays V and XY must be aligned to a multiple of 64
+ * bytes.
+ *
+ * Use the NEON instruction set.  This function is only available if the
+ * compiler targets NEON, see CRYPTO_SCRYPT_SMIX_NEON_AVAILABLE.
+ */
+#if defined(__ARM_NEON)
+#define CRYPTO_SCRYPT_SMIX_NEON_AVAILABLE 1
+void crypto_scrypt_smix_neon(uint8_t *, size_t, uint64_t, void *, void *);
+#endif
+
+#endif /* !_CRYPTO_SCRYPT_SMIX_NEON_H_ */
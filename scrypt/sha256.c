@@ -26,12 +26,16 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "insecure_memzero.h"
 #include "sysendian.h"
 
+#include "sha256_arm.h"
+#include "sha256_shani.h"
+
 #include "sha256.h"
 
 /*
@@ -121,7 +125,7 @@ static const uint32_t Krnd[64] = {
  * the 512-bit input block to produce a new state.
  */
 static void
-SHA256_Transform(uint32_t state[static restrict 8],
+SHA256_Transform_generic(uint32_t state[static restrict 8],
     const uint8_t block[static restrict 64],
     uint32_t W[static restrict 64], uint32_t S[static restrict 8])
 {
@@ -177,6 +181,86 @@ SHA256_Transform(uint32_t state[static restrict 8],
 		state[i] += S[i];
 }
 
+/* Hardware transform to use, selected on first use by selecttransform(). */
+static void (*transform_func)(uint32_t[8], const uint8_t[64]) = NULL;
+static pthread_once_t transform_once = PTHREAD_ONCE_INIT;
+
+/**
+ * testtransform(transform):
+ * Return 0 if ${transform} computes SHA256("abc") correctly; or -1 otherwise.
+ */
+static int
+testtransform(void (*transform)(uint32_t[8], const uint8_t[64]))
+{
+	static const uint32_t initial[8] = {
+		0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+		0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+	};
+	static const uint32_t expected[8] = {
+		0xBA7816BF, 0x8F01CFEA, 0x414140DE, 0x5DAE2223,
+		0xB00361A3, 0x96177A9C, 0xB410FF61, 0xF20015AD
+	};
+	uint32_t state[8];
+	uint8_t block[64];
+
+	/* The padded block of "abc". */
+	memset(block, 0, 64);
+	memcpy(block, "abc", 3);
+	block[3] = 0x80;
+	block[63] = 24;
+
+	/* Perform the computation. */
+	memcpy(state, initial, 32);
+	(transform)(state, block);
+
+	/* Does it match? */
+	return (memcmp(state, expected, 32) ? -1 : 0);
+}
+
+/**
+ * selecttransform(void):
+ * Pick a hardware transform which the CPU supports and which computes the
+ * test vector correctly, if there is one.
+ */
+static void
+selecttransform(void)
+{
+
+#ifdef SHA256_ARM_AVAILABLE
+	if (!testtransform(SHA256_Transform_arm)) {
+		transform_func = SHA256_Transform_arm;
+		return;
+	}
+#endif
+#ifdef SHA256_SHANI_AVAILABLE
+	if (SHA256_shani_supported() &&
+	    !testtransform(SHA256_Transform_shani)) {
+		transform_func = SHA256_Transform_shani;
+		return;
+	}
+#endif
+}
+
+/*
+ * SHA256 block compression function, using a hardware implementation if one
+ * is available.  The temporary space ${W} and ${S} is only used by the
+ * generic implementation.
+ */
+static void
+SHA256_Transform(uint32_t state[static restrict 8],
+    const uint8_t block[static restrict 64],
+    uint32_t W[static restrict 64], uint32_t S[static restrict 8])
+{
+
+	/* Pick the transform on first use. */
+	pthread_once(&transform_once, selecttransform);
+
+	if (transform_func != NULL)
+		(transform_func)(state, block);
+	else
+		SHA256_Transform_generic(state, block, W, S);
+}
+
 static const uint8_t PAD[64] = {
 	0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
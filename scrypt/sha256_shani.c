@@ -0,0 +1,140 @@
+/*-
+ * Copyright 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "sha256_shani.h"
+
+#ifdef SHA256_SHANI_AVAILABLE
+
+#include <cpuid.h>
+#include <immintrin.h>
+#include <stdint.h>
+
+static const uint32_t Krnd[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+/**
+ * SHA256_shani_supported(void):
+ * Return nonzero if the CPU supports the SHA extensions as well as SSSE3 and
+ * SSE4.1; or zero otherwise.
+ */
+int
+SHA256_shani_supported(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	/* SSSE3 and SSE4.1 are reported in leaf 1. */
+	if (__get_cpuid_max(0, NULL) < 7)
+		return (0);
+	__cpuid(1, eax, ebx, ecx, edx);
+	if (!(ecx & (1 << 9)) || !(ecx & (1 << 19)))
+		return (0);
+
+	/* SHA is reported in leaf 7, subleaf 0. */
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return ((ebx & (1 << 29)) != 0);
+}
+
+/**
+ * SHA256_Transform_shani(state, block):
+ * Compute the SHA256 block compression function, transforming ${state} using
+ * the data in ${block}.  This implementation uses x86 SHA-NI instructions,
+ * and should only be used if SHA256_shani_supported() returns nonzero.
+ */
+__attribute__((target("sha,ssse3,sse4.1")))
+void
+SHA256_Transform_shani(uint32_t state[8], const uint8_t block[64])
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+	    0x0405060700010203ULL);
+	__m128i W[4];
+	__m128i ABEF, CDGH, ABEF_SAVE, CDGH_SAVE;
+	__m128i T0, T1;
+	int i;
+
+	/* Load state, rearranged to (A, B, E, F) and (C, D, G, H). */
+	T0 = _mm_loadu_si128((const __m128i *)&state[0]);
+	T1 = _mm_loadu_si128((const __m128i *)&state[4]);
+	T0 = _mm_shuffle_epi32(T0, 0xB1);
+	T1 = _mm_shuffle_epi32(T1, 0x1B);
+	ABEF = _mm_alignr_epi8(T0, T1, 8);
+	CDGH = _mm_blend_epi16(T1, T0, 0xF0);
+	ABEF_SAVE = ABEF;
+	CDGH_SAVE = CDGH;
+
+	/* Load the block, converting the words from big-endian. */
+	for (i = 0; i < 4; i++) {
+		W[i] = _mm_shuffle_epi8(
+		    _mm_loadu_si128((const __m128i *)&block[i * 16]), bswap);
+	}
+
+	/* Perform 4 rounds at a time, expanding the message schedule. */
+	for (i = 0; i < 16; i++) {
+		T0 = _mm_add_epi32(W[i % 4],
+		    _mm_loadu_si128((const __m128i *)&Krnd[i * 4]));
+		CDGH = _mm_sha256rnds2_epu32(CDGH, ABEF, T0);
+		ABEF = _mm_sha256rnds2_epu32(ABEF, CDGH,
+		    _mm_shuffle_epi32(T0, 0x0E));
+
+		/* Compute the message words used 4 groups of rounds later. */
+		if (i < 12) {
+			T1 = _mm_alignr_epi8(W[(i + 3) % 4], W[(i + 2) % 4], 4);
+			W[i % 4] = _mm_sha256msg1_epu32(W[i % 4],
+			    W[(i + 1) % 4]);
+			W[i % 4] = _mm_add_epi32(W[i % 4], T1);
+			W[i % 4] = _mm_sha256msg2_epu32(W[i % 4],
+			    W[(i + 3) % 4]);
+		}
+	}
+
+	/* Mix local working variables into global state. */
+	ABEF = _mm_add_epi32(ABEF, ABEF_SAVE);
+	CDGH = _mm_add_epi32(CDGH, CDGH_SAVE);
+
+	/* Store state, rearranged back to (A, B, C, D) and (E, F, G, H). */
+	T0 = _mm_shuffle_epi32(ABEF, 0x1B);
+	T1 = _mm_shuffle_epi32(CDGH, 0xB1);
+	_mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(T0, T1, 0xF0));
+	_mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(T1, T0, 8));
+}
+
+#endif /* SHA256_SHANI_AVAILABLE */